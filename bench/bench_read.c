@@ -0,0 +1,157 @@
+#include <stdatomic.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "lambda-json.h"
+
+/* Read benchmark:
+ *   Measures lookups per second on a document shared between threads, read
+ *   directly, and through a slot that a publisher keeps replacing the
+ *   document of. Usage: bench_read [max threads] [lookups per thread] */
+
+#define N_KEYS      256
+#define MAX_THREADS 64
+
+static ljson_t      *_json;
+static ljson_slot_t *_slot;
+static unsigned long _lookups = 1000000;
+
+/**
+ * Parse { "key0": 0, "key1": 1, ... } */
+static ljson_t *_build(void) {
+    static char text[N_KEYS * 24];
+    size_t used = 0;
+
+    text[used++] = '{';
+    for(int i = 0; i < N_KEYS; i++) {
+        used += (size_t)snprintf(&text[used], sizeof(text) - used, "%s\"key%d\":%d", i ? "," : "", i, i);
+    }
+    text[used++] = '}';
+    text[used]   = '\0';
+
+    return ljson_parse(text, 0);
+}
+
+static int _lookup(ljson_t *json, unsigned long i) {
+    char key[16];
+    snprintf(key, sizeof(key), "key%lu", i % N_KEYS);
+    return ljson_map_search(json->root.map, key) != NULL;
+}
+
+static void *_read_direct(void *arg) {
+    unsigned long found = 0;
+    for(unsigned long i = 0; i < _lookups; i++) {
+        found += (unsigned long)_lookup(_json, i);
+    }
+    *(unsigned long *)arg = found;
+    return NULL;
+}
+
+static void *_read_slot(void *arg) {
+    unsigned long found = 0;
+    for(unsigned long i = 0; i < _lookups; i++) {
+        ljson_shared_t *shared = ljson_slot_acquire(_slot);
+        found += (unsigned long)_lookup(ljson_shared_doc(shared), i);
+        ljson_shared_unref(shared);
+    }
+    *(unsigned long *)arg = found;
+    return NULL;
+}
+
+static atomic_int _publishing;
+
+static void *_publish(void *arg) {
+    unsigned long *published = (unsigned long *)arg;
+    while(atomic_load(&_publishing)) {
+        ljson_shared_t *shared = ljson_shared_create(_build());
+        if(shared) {
+            ljson_slot_publish(_slot, shared);
+            ljson_shared_unref(shared);
+            (*published)++;
+        }
+        nanosleep(&(struct timespec){ .tv_nsec = 1000000 }, NULL);
+    }
+    return NULL;
+}
+
+static double _now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ((double)ts.tv_nsec / 1e9);
+}
+
+static void _run(const char *name, void *(*fn)(void *), int threads, int publish) {
+    pthread_t     tids[MAX_THREADS];
+    unsigned long found[MAX_THREADS];
+    pthread_t     publisher;
+    unsigned long published = 0;
+
+    memset(found, 0, sizeof(found));
+    atomic_store(&_publishing, publish);
+    if(publish && pthread_create(&publisher, NULL, _publish, &published)) {
+        atomic_store(&_publishing, 0);
+        publish = 0;
+    }
+
+    double start = _now();
+    int started = 0;
+    for(; started < threads; started++) {
+        if(pthread_create(&tids[started], NULL, fn, &found[started])) {
+            break;
+        }
+    }
+    unsigned long total = 0;
+    for(int i = 0; i < started; i++) {
+        pthread_join(tids[i], NULL);
+        total += found[i];
+    }
+    double elapsed = _now() - start;
+
+    atomic_store(&_publishing, 0);
+    if(publish) {
+        pthread_join(publisher, NULL);
+    }
+
+    printf("%-8s %2d threads: %8.2f Mlookups/s, %lu found, %lu published\n",
+           name, started, (double)total / elapsed / 1e6, total, published);
+}
+
+int main(int argc, char **argv) {
+    int max_threads = 8;
+    if(argc > 1) {
+        max_threads = atoi(argv[1]);
+    }
+    if((max_threads < 1) || (max_threads > MAX_THREADS)) {
+        max_threads = MAX_THREADS;
+    }
+    if(argc > 2) {
+        _lookups = strtoul(argv[2], NULL, 10);
+    }
+
+    _json = _build();
+    if(!_json) {
+        fprintf(stderr, "Could not build document\n");
+        return -1;
+    }
+
+    ljson_shared_t *shared = ljson_shared_create(_json);
+    _slot = ljson_slot_create(shared);
+    if(!shared || !_slot) {
+        fprintf(stderr, "Could not share document\n");
+        return -1;
+    }
+
+    for(int threads = 1; threads <= max_threads; threads *= 2) {
+        _run("direct", _read_direct, threads, 0);
+        _run("slot",   _read_slot,   threads, 0);
+        _run("reload", _read_slot,   threads, 1);
+    }
+
+    ljson_slot_destroy(_slot);
+    ljson_shared_unref(shared);
+
+    return 0;
+}
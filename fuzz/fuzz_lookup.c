@@ -0,0 +1,91 @@
+#include <string.h>
+#include <stdlib.h>
+
+#include "lambda-json.h"
+
+/* Fuzz target: lookup and modification APIs
+ *   Input is a key, a NUL, then a JSON document. Every map in the document is
+ *   searched for the key and for each of its own keys, every item is run
+ *   through the number conversions, and the key is set and removed on the
+ *   root map. */
+
+static const ljson_itemtype_e _types[] = {
+    LJSON_ITEMTYPE_NONE,    LJSON_ITEMTYPE_NULL,      LJSON_ITEMTYPE_STRING,
+    LJSON_ITEMTYPE_INTEGER, LJSON_ITEMTYPE_FLOAT,     LJSON_ITEMTYPE_ARRAY,
+    LJSON_ITEMTYPE_MAP,     LJSON_ITEMTYPE_RAWNUMBER, LJSON_ITEMTYPE_BOOLEAN
+};
+#define N_TYPES (sizeof(_types) / sizeof(_types[0]))
+
+static void _walk(const ljson_item_t *item, const char *key) {
+    LJSON_INTTYPE   integer;
+    LJSON_FLOATTYPE flt;
+    (void)ljson_number_int(item, &integer);
+    (void)ljson_number_float(item, &flt);
+
+    if(item->type == LJSON_ITEMTYPE_ARRAY) {
+        for(uint16_t i = 0; i < item->array->count; i++) {
+            _walk(&item->array->items[i], key);
+        }
+    } else if(item->type == LJSON_ITEMTYPE_MAP) {
+        ljson_map_t *map = item->map;
+        (void)ljson_map_search(map, key);
+        for(unsigned t = 0; t < N_TYPES; t++) {
+            ljson_item_t *found = ljson_map_search_type(map, key, _types[t]);
+            if(found && (found->type != _types[t])) {
+                abort();
+            }
+        }
+
+        for(uint16_t i = 0; i < map->count; i++) {
+            /* Must find the first mapping with this key */
+            ljson_item_t *found = ljson_map_search(map, map->items[i].name);
+            uint16_t      first = 0;
+            while(strcmp(map->items[first].name, map->items[i].name)) {
+                first++;
+            }
+            if(found != &map->items[first].item) {
+                abort();
+            }
+            _walk(&map->items[i].item, key);
+        }
+    }
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    const uint8_t *sep = (const uint8_t *)memchr(data, '\0', size);
+    if(!sep) {
+        return 0;
+    }
+    const char *key  = (const char *)data;
+    const char *body = (const char *)(sep + 1);
+    size_t      len  = size - (size_t)(sep + 1 - data);
+
+    ljson_t *json = ljson_parse_len(body, len, 0);
+    if(!json) {
+        return 0;
+    }
+
+    _walk(&json->root, key);
+
+    if(json->root.type == LJSON_ITEMTYPE_MAP) {
+        const ljson_item_t value = { .type = LJSON_ITEMTYPE_INTEGER, .integer = 1 };
+        int existed = (ljson_map_search(json->root.map, key) != NULL);
+
+        ljson_item_t *set = ljson_map_set(json, &json->root, key, &value);
+        if(set && (ljson_map_search(json->root.map, key) != set)) {
+            abort();
+        }
+        if(set && ljson_map_remove(json, &json->root, key)) {
+            abort();
+        }
+        if(set && !existed && ljson_map_search(json->root.map, key)) {
+            abort();
+        }
+    }
+
+    ljson_destroy(json);
+
+    return 0;
+}
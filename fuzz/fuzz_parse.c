@@ -0,0 +1,205 @@
+#define _GNU_SOURCE
+#include <sys/mman.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include "lambda-json.h"
+
+/* Fuzz target: ljson_parse
+ *   The first byte of the input selects parse flags, the rest is parsed by the
+ *   reference parser, ljson_parse_len. Every alternate engine below is then
+ *   run on the same input, and must agree with the reference on whether the
+ *   input is valid, and on the resulting document. */
+
+/** Flags the first input byte may select */
+#define FUZZ_FLAGS (LJSON_PARSEFLAG_LENIENT | LJSON_PARSEFLAG_RAWNUMBERS | LJSON_PARSEFLAG_STRICT)
+
+/**
+ * Alternate engine: parses input, returning NULL on failure. Returns
+ * FUZZ_SKIP if the engine cannot handle this input. */
+typedef ljson_t *(*fuzz_engine_t)(const char *data, size_t len, uint32_t flags, const ljson_t *ref);
+#define FUZZ_SKIP ((ljson_t *)-1)
+
+/**
+ * Write data to an in-memory file, returning a path to it in path. */
+static int _memfile(const void *data, size_t len, char *path, size_t pathlen) {
+    int fd = memfd_create("ljson-fuzz", 0);
+    if(fd < 0) {
+        return -1;
+    }
+    if(len && (write(fd, data, len) != (ssize_t)len)) {
+        close(fd);
+        return -1;
+    }
+    snprintf(path, pathlen, "/proc/self/fd/%d", fd);
+    return fd;
+}
+
+static ljson_t *_engine_ctx(const char *data, size_t len, uint32_t flags, const ljson_t *ref) {
+    static ljson_ctx_t *ctx = NULL;
+    (void)ref;
+
+    if(memchr(data, '\0', len)) {
+        /* ljson_parse_into stops at the first NUL */
+        return FUZZ_SKIP;
+    }
+    if(!ctx && !(ctx = ljson_ctx_create(256))) {
+        return FUZZ_SKIP;
+    }
+
+    /* The context is reused across inputs, as it would be in a real program.
+     * Documents from it must be copied out, as the next parse invalidates
+     * them. */
+    char *str = strndup(data, len);
+    if(!str) {
+        return FUZZ_SKIP;
+    }
+    ljson_t *json = ljson_parse_into(ctx, str, flags);
+    ljson_t *copy = NULL;
+    if(json) {
+        copy = ljson_create(NULL);
+        if(!copy || ljson_item_set(copy, &copy->root, &json->root)) {
+            abort();
+        }
+    }
+    free(str);
+    return copy;
+}
+
+static ljson_t *_engine_zerocopy(const char *data, size_t len, uint32_t flags, const ljson_t *ref) {
+    (void)ref;
+
+    char path[64];
+    int  fd = _memfile(data, len, path, sizeof(path));
+    if(fd < 0) {
+        return FUZZ_SKIP;
+    }
+    ljson_t *json = ljson_parse_file(path, flags | LJSON_PARSEFLAG_ZEROCOPY);
+    close(fd);
+    return json;
+}
+
+static ljson_t *_engine_binary(const char *data, size_t len, uint32_t flags, const ljson_t *ref) {
+    (void)data; (void)len; (void)flags;
+
+    if(!ref) {
+        /* Nothing to save */
+        return NULL;
+    }
+
+    char path[64];
+    int  fd = _memfile(NULL, 0, path, sizeof(path));
+    if(fd < 0) {
+        return FUZZ_SKIP;
+    }
+    ljson_t *json = NULL;
+    if(!ljson_save_binary(ref, path)) {
+        json = ljson_load_binary(path, 0);
+    }
+    close(fd);
+    return json;
+}
+
+/**
+ * Structural comparison, independent of the library. Keys must be in the same
+ * order, and floats must have the same representation. */
+static int _equal(const ljson_item_t *a, const ljson_item_t *b) {
+    if(a->type != b->type) {
+        return 0;
+    }
+
+    switch(a->type) {
+        case LJSON_ITEMTYPE_STRING:
+        case LJSON_ITEMTYPE_RAWNUMBER:
+            return !strcmp(a->str, b->str);
+
+        case LJSON_ITEMTYPE_BOOLEAN:
+            return a->boolean == b->boolean;
+
+        case LJSON_ITEMTYPE_INTEGER:
+            return a->integer == b->integer;
+
+        case LJSON_ITEMTYPE_FLOAT:
+            return !memcmp(&a->flt, &b->flt, sizeof(a->flt));
+
+        case LJSON_ITEMTYPE_ARRAY:
+            if(a->array->count != b->array->count) {
+                return 0;
+            }
+            for(uint16_t i = 0; i < a->array->count; i++) {
+                if(!_equal(&a->array->items[i], &b->array->items[i])) {
+                    return 0;
+                }
+            }
+            return 1;
+
+        case LJSON_ITEMTYPE_MAP:
+            if(a->map->count != b->map->count) {
+                return 0;
+            }
+            for(uint16_t i = 0; i < a->map->count; i++) {
+                if(strcmp(a->map->items[i].name, b->map->items[i].name) ||
+                   !_equal(&a->map->items[i].item, &b->map->items[i].item)) {
+                    return 0;
+                }
+            }
+            return 1;
+
+        case LJSON_ITEMTYPE_NULL:
+        case LJSON_ITEMTYPE_NONE:
+            return 1;
+    }
+
+    return 0;
+}
+
+static const struct {
+    const char   *name;
+    fuzz_engine_t parse;
+} _engines[] = {
+    { "context",  _engine_ctx },
+    { "zerocopy", _engine_zerocopy },
+    { "binary",   _engine_binary },
+};
+#define N_ENGINES (sizeof(_engines) / sizeof(_engines[0]))
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    if(size < 1) {
+        return 0;
+    }
+    uint32_t    flags = data[0] & FUZZ_FLAGS;
+    const char *body  = (const char *)&data[1];
+    size_t      len   = size - 1;
+
+    ljson_t *ref = ljson_parse_len(body, len, flags);
+
+    for(unsigned i = 0; i < N_ENGINES; i++) {
+        ljson_t *alt = _engines[i].parse(body, len, flags, ref);
+        if(alt == FUZZ_SKIP) {
+            continue;
+        }
+
+        if(!ref != !alt) {
+            fprintf(stderr, "engine %s: %s where reference %s\n", _engines[i].name,
+                    alt ? "succeeded" : "failed", ref ? "succeeded" : "failed");
+            abort();
+        }
+        if(alt) {
+            if(!_equal(&ref->root, &alt->root)) {
+                fprintf(stderr, "engine %s: document differs from reference\n", _engines[i].name);
+                abort();
+            }
+            ljson_destroy(alt);
+        }
+    }
+
+    if(ref) {
+        ljson_destroy(ref);
+    }
+
+    return 0;
+}
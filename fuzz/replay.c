@@ -0,0 +1,35 @@
+#include <stdlib.h>
+#include <stdio.h>
+
+#include <stdint.h>
+
+/* Replays inputs through a fuzz target, for compilers without libFuzzer.
+ * Each argument is a file holding one input. */
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+int main(int argc, char **argv) {
+    for(int i = 1; i < argc; i++) {
+        FILE *fp = fopen(argv[i], "rb");
+        if(!fp) {
+            fprintf(stderr, "could not open %s\n", argv[i]);
+            return -1;
+        }
+
+        fseek(fp, 0, SEEK_END);
+        long size = ftell(fp);
+        fseek(fp, 0, SEEK_SET);
+
+        uint8_t *data = (uint8_t *)malloc(size ? (size_t)size : 1);
+        if(!data || (fread(data, 1, (size_t)size, fp) != (size_t)size)) {
+            fprintf(stderr, "could not read %s\n", argv[i]);
+            return -1;
+        }
+        fclose(fp);
+
+        LLVMFuzzerTestOneInput(data, (size_t)size);
+        free(data);
+    }
+
+    return 0;
+}
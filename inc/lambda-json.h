@@ -1,6 +1,7 @@
 #ifndef LIB_LAMBDA_JSON_H
 #define LIB_LAMBDA_JSON_H
 
+#include <stddef.h>
 #include <stdint.h>
 
 #ifdef __cplusplus
@@ -10,30 +11,69 @@ extern "C" {
 /* @note If these are changed, they MUST also be changed when compiling the
  * library. */
 #ifndef LJSON_INTTYPE
-/** Type to use for storing JSON integers */
-#  define LJSON_INTTYPE   int
+/** Type to use for storing JSON integers, must be signed. Integers that do
+ * not fit fail to parse, see LJSON_PARSEFLAG_RAWNUMBERS to handle them. */
+#  define LJSON_INTTYPE   int64_t
 #endif
 #ifndef LJSON_FLOATTYPE
 /** Type to use for storing JSON floating-points */
 #  define LJSON_FLOATTYPE double
 #endif
 
+#define LJSON_FEATURE_FLOAT     (1UL << 0) /** Numbers with a decimal portion */
+#define LJSON_FEATURE_SQUOTE    (1UL << 1) /** Strings and keys enclosed in '...' */
+#define LJSON_FEATURE_RAWNUMBER (1UL << 2) /** LJSON_PARSEFLAG_RAWNUMBERS */
+#define LJSON_FEATURE_ALL       (LJSON_FEATURE_FLOAT  | \
+                                 LJSON_FEATURE_SQUOTE | \
+                                 LJSON_FEATURE_RAWNUMBER)
+
+#ifndef LJSON_FEATURES
+/** Parser features to compile in, see LJSON_FEATURE_*. Input relying on a
+ * feature that is left out fails to parse. */
+#  define LJSON_FEATURES LJSON_FEATURE_ALL
+#endif
+
 typedef struct ljson_mapitem_struct ljson_mapitem_t;
 typedef struct ljson_map_struct     ljson_map_t;
 typedef struct ljson_array_struct   ljson_array_t;
 typedef struct ljson_item_struct    ljson_item_t;
 typedef struct ljson_struct         ljson_t;
+typedef struct ljson_ctx_struct     ljson_ctx_t;
+typedef struct ljson_shared_struct  ljson_shared_t;
+typedef struct ljson_slot_struct    ljson_slot_t;
+typedef struct ljson_hashes_struct  ljson_hashes_t;
+
+/*
+ * Thread safety:
+ *
+ * Documents hold no hidden state, functions only reading a document never
+ * write to it. Any number of threads may therefore use ljson_map_search,
+ * ljson_map_search_type, ljson_number_int, ljson_number_float, ljson_hash,
+ * ljson_diff and ljson_save_binary on the same document at once, as long as no
+ * thread modifies or destroys it meanwhile. Items may also be read directly.
+ * Likewise, hash trees from ljson_hash are only read by ljson_diff_hashed.
+ *
+ * Functions modifying a document, including ljson_merge, require exclusive
+ * access to it. A context may only be used by one thread at a time, which
+ * includes parsing into it and modifying documents allocated from it.
+ * Parsing, loading and destroying distinct documents from different threads
+ * is safe.
+ *
+ * To replace a document shared between threads, see ljson_slot_t.
+ */
 
 /**
  * JSON object types */
 typedef enum {
-    LJSON_ITEMTYPE_NONE = 0, /** Invalid */
-    LJSON_ITEMTYPE_NULL,     /** null */
-    LJSON_ITEMTYPE_STRING,   /** "..." or '...' */
-    LJSON_ITEMTYPE_INTEGER,  /** Whole number */
-    LJSON_ITEMTYPE_FLOAT,    /** Number with decimal portion */
-    LJSON_ITEMTYPE_ARRAY,    /** [ ... ] */
-    LJSON_ITEMTYPE_MAP       /** { "...": ... } */
+    LJSON_ITEMTYPE_NONE = 0,   /** Invalid */
+    LJSON_ITEMTYPE_NULL,       /** null */
+    LJSON_ITEMTYPE_STRING,     /** "..." or '...' */
+    LJSON_ITEMTYPE_INTEGER,    /** Whole number */
+    LJSON_ITEMTYPE_FLOAT,      /** Number with decimal portion */
+    LJSON_ITEMTYPE_ARRAY,      /** [ ... ] */
+    LJSON_ITEMTYPE_MAP,        /** { "...": ... } */
+    LJSON_ITEMTYPE_RAWNUMBER,  /** Number kept as text, see LJSON_PARSEFLAG_RAWNUMBERS */
+    LJSON_ITEMTYPE_BOOLEAN     /** true or false */
 } ljson_itemtype_e;
 
 /**
@@ -41,7 +81,8 @@ typedef enum {
 struct ljson_item_struct {
     ljson_itemtype_e type;       /** Type of this object */
     union {
-        char           *str;     /** String data */
+        char           *str;     /** String data, or text of raw number */
+        int             boolean; /** Boolean data, 0 or 1 */
         LJSON_INTTYPE   integer; /** Integer data */
         LJSON_FLOATTYPE flt;     /** Floating-point data */
         ljson_map_t    *map;     /** Map { "...": ... } */
@@ -59,24 +100,32 @@ struct ljson_mapitem_struct {
 /**
  * Represents a JSON map */
 struct ljson_map_struct {
-    uint16_t        count;   /** Number of mappings in map */
-    ljson_mapitem_t items[]; /** Mappings */
+    uint16_t        count;    /** Number of mappings in map */
+    uint16_t        capacity; /** Number of mappings there is room for */
+    ljson_mapitem_t items[];  /** Mappings */
 };
 
 /**
  * Represents a JSON array */
 struct ljson_array_struct {
-    uint16_t     count;   /** Number of items in array */
-    ljson_item_t items[]; /** Array items */
+    uint16_t     count;    /** Number of items in array */
+    uint16_t     capacity; /** Number of items there is room for */
+    ljson_item_t items[];  /** Array items */
 };
 
 /**
  * Represents an entire JSON file */
 struct ljson_struct {
     ljson_item_t root;
+    ljson_ctx_t *ctx;  /** Context owning this document, NULL if allocated on the heap */
 };
 
-#define LJSON_PARSEFLAG_LENIENT (1UL << 0) /** Allow characters after parsable JSON string */
+#define LJSON_PARSEFLAG_LENIENT    (1UL << 0) /** Allow characters after parsable JSON string */
+#define LJSON_PARSEFLAG_ZEROCOPY   (1UL << 1) /** ljson_parse_file: Strings reference the file mapping, rather than being copied */
+#define LJSON_PARSEFLAG_WILLNEED   (1UL << 2) /** ljson_parse_file, ljson_load_binary: Ask the kernel to read the whole file ahead of use */
+#define LJSON_PARSEFLAG_NOCHECKSUM (1UL << 3) /** ljson_load_binary: Skip verifying the image checksum, which reads the whole image. The structure is still validated */
+#define LJSON_PARSEFLAG_RAWNUMBERS (1UL << 4) /** Keep numbers as text, for later conversion with ljson_number_* */
+#define LJSON_PARSEFLAG_STRICT     (1UL << 5) /** Reject '...' strings, leading +, literals in other case, and numbers outside the JSON grammar (e.g. 01, .5, 1.). Escapes are still not validated */
 
 /**
  * Parse JSON-formatted string, returning an object representation.
@@ -89,12 +138,111 @@ struct ljson_struct {
 ljson_t *ljson_parse(const char *body, uint32_t flags);
 
 /**
- * De-allocate JSON object previously generated using ljson_parse.
+ * Parse JSON-formatted input of known length, which need not be
+ * NUL-terminated. @see ljson_parse
+ * 
+ * @param body Input to parse
+ * @param len Length of body in bytes
+ * @param flags Flags modifying the parsing, see LJSON_PARSEFLAG_*
+ * 
+ * @return NULL on error, else pointer to object repesenting JSON input
+ */
+ljson_t *ljson_parse_len(const char *body, size_t len, uint32_t flags);
+
+/**
+ * Parse JSON-formatted file, by mapping it into memory rather than reading it
+ * into a buffer. The mapping is only kept for the lifetime of the document if
+ * LJSON_PARSEFLAG_ZEROCOPY is given, in which case strings are unescaped and
+ * terminated within a private copy-on-write mapping of the file, and the
+ * document owns all of its storage in a private context. Only arrays and maps
+ * are allocated from the heap then, in blocks that start at a fraction of
+ * the file size and grow as needed. Pages of the mapping holding strings are
+ * copied on write, as strings are terminated in place.
+ * 
+ * @param path Path of file to parse
+ * @param flags Flags modifying the parsing, see LJSON_PARSEFLAG_*
+ * 
+ * @return NULL on error, else pointer to object repesenting JSON input
+ */
+ljson_t *ljson_parse_file(const char *path, uint32_t flags);
+
+/**
+ * Parse JSON-formatted string into a reusable context. The context is reset
+ * before parsing, so any document previously parsed into it becomes invalid.
+ * Storage is kept between calls, so repeatedly parsing similarly-sized
+ * documents does not touch the heap once the context has grown to fit them.
+ * 
+ * @param ctx Context to parse into, see ljson_ctx_create
+ * @param body String to parse
+ * @param flags Flags modifying the parsing, see LJSON_PARSEFLAG_*
+ * 
+ * @return NULL on error, else pointer to object repesenting JSON input, valid
+ *         until ctx is next reset or destroyed
+ */
+ljson_t *ljson_parse_into(ljson_ctx_t *ctx, const char *body, uint32_t flags);
+
+/**
+ * De-allocate JSON object previously generated using ljson_parse. Documents
+ * owned by a context are left alone, they are released with the context.
  * 
  * @param json JSON object to destroy
  */
 void ljson_destroy(ljson_t *json);
 
+/**
+ * Write document to a binary image, which can be loaded by ljson_load_binary
+ * much faster than the JSON source can be parsed. Images hold the document in
+ * its in-memory representation, so they may only be loaded by builds of the
+ * library using the same LJSON_INTTYPE, LJSON_FLOATTYPE and architecture.
+ * 
+ * @param json Document to write
+ * @param path Path of file to write image to
+ * 
+ * @return 0 on success, else -1
+ */
+int ljson_save_binary(const ljson_t *json, const char *path);
+
+/**
+ * Load document from a binary image written by ljson_save_binary. The image
+ * is mapped privately into memory and used in place, rather than parsed.
+ * Every pointer in the image is relocated on load, so each page holding
+ * arrays and maps is written to, and copied by the kernel. Unless
+ * LJSON_PARSEFLAG_NOCHECKSUM is given, the whole image, strings included, is
+ * also read once to verify its checksum. Callers loading trusted images can
+ * pass that flag so that string pages are only read when used.
+ * 
+ * @param path Path of image to load
+ * @param flags Flags modifying the loading, see LJSON_PARSEFLAG_*
+ * 
+ * @return NULL on error or invalid image, else pointer to document
+ */
+ljson_t *ljson_load_binary(const char *path, uint32_t flags);
+
+/**
+ * Create a parsing context for use with ljson_parse_into.
+ * 
+ * @param size Initial size of the context's storage in bytes, 0 for default
+ * 
+ * @return NULL on error, else pointer to new context
+ */
+ljson_ctx_t *ljson_ctx_create(size_t size);
+
+/**
+ * Invalidate all documents parsed into the context, keeping its storage for
+ * the next parse. If the last document did not fit the storage, it is
+ * replaced by a single allocation large enough to hold it.
+ * 
+ * @param ctx Context to reset
+ */
+void ljson_ctx_reset(ljson_ctx_t *ctx);
+
+/**
+ * De-allocate a context, and all documents parsed into it.
+ * 
+ * @param ctx Context to destroy
+ */
+void ljson_ctx_destroy(ljson_ctx_t *ctx);
+
 /**
  * Search for item corresponding to the given key within a map.
  * 
@@ -105,6 +253,266 @@ void ljson_destroy(ljson_t *json);
  */
 ljson_item_t *ljson_map_search(ljson_map_t *map, const char *key);
 
+/**
+ * Create an empty document, with a null root, for building with the functions
+ * below.
+ * 
+ * @param ctx Context to allocate the document from, NULL to use the heap. The
+ *        context is not reset.
+ * 
+ * @return NULL on error, else pointer to new document
+ */
+ljson_t *ljson_create(ljson_ctx_t *ctx);
+
+/*
+ * Document modification:
+ *
+ * Values passed in are deep-copied into json, so they may come from anywhere,
+ * including json itself. An array or map value with a NULL pointer stands for
+ * an empty one. Arrays and maps grow as needed, pointers to their items are
+ * only valid until the next insertion. Storage of removed or replaced values
+ * is freed immediately for documents on the heap, and on context reset
+ * otherwise.
+ */
+
+/**
+ * Replace the value of an item within json.
+ * 
+ * @param json Document containing item
+ * @param item Item to modify
+ * @param value New value
+ * 
+ * @return 0 on success, else -1
+ */
+int ljson_item_set(ljson_t *json, ljson_item_t *item, const ljson_item_t *value);
+
+/**
+ * Add a value to the end of an array.
+ * 
+ * @param json Document containing array
+ * @param array Array item to append to
+ * @param value Value to append
+ * 
+ * @return NULL on error, else pointer to the new item
+ */
+ljson_item_t *ljson_array_append(ljson_t *json, ljson_item_t *array, const ljson_item_t *value);
+
+/**
+ * Insert a value into an array, before the item at index.
+ * 
+ * @param json Document containing array
+ * @param array Array item to insert into
+ * @param index Position of the new item, at most the array's count
+ * @param value Value to insert
+ * 
+ * @return NULL on error, else pointer to the new item
+ */
+ljson_item_t *ljson_array_insert(ljson_t *json, ljson_item_t *array, uint16_t index, const ljson_item_t *value);
+
+/**
+ * Remove the item at index from an array.
+ * 
+ * @param json Document containing array
+ * @param array Array item to remove from
+ * @param index Position of the item to remove
+ * 
+ * @return 0 on success, -1 if there is no such item
+ */
+int ljson_array_remove(ljson_t *json, ljson_item_t *array, uint16_t index);
+
+/**
+ * Set the value mapped to key, replacing its current value if it exists, else
+ * adding it to the end of the map.
+ * 
+ * @param json Document containing map
+ * @param map Map item to modify
+ * @param key Key to set
+ * @param value Value to set
+ * 
+ * @return NULL on error, else pointer to the mapped item
+ */
+ljson_item_t *ljson_map_set(ljson_t *json, ljson_item_t *map, const char *key, const ljson_item_t *value);
+
+/**
+ * Remove a key and its value from a map, keeping the order of other keys.
+ * 
+ * @param json Document containing map
+ * @param map Map item to modify
+ * @param key Key to remove
+ * 
+ * @return 0 on success, -1 if key is not present
+ */
+int ljson_map_remove(ljson_t *json, ljson_item_t *map, const char *key);
+
+/**
+ * Compute the changes turning a into b, as a JSON Patch (RFC 6902) document:
+ * an array of { "op": ..., "path": ..., "value": ... } maps, using the "add",
+ * "remove" and "replace" operations. Neither input is modified.
+ * 
+ * Arrays and maps with equal 64-bit content hashes are taken to be identical,
+ * and skipped without being compared item by item. Should the hashes of two
+ * different containers collide, which is very unlikely but not impossible,
+ * their differences are missing from the patch. Other values with equal
+ * hashes are compared exactly.
+ * 
+ * @param a Original value
+ * @param b Changed value
+ * 
+ * @return NULL on error, else patch document to be destroyed with
+ *         ljson_destroy. Its root array is empty if a and b are equal.
+ */
+ljson_t *ljson_diff(const ljson_item_t *a, const ljson_item_t *b);
+
+/**
+ * Compute the content hashes of an item and everything below it, for use
+ * with ljson_diff_hashed. Keeping the hashes of a base document avoids
+ * rehashing it for every version it is diffed against.
+ * 
+ * @param item Value to hash. It must not be modified or destroyed while the
+ *        hashes are in use.
+ * 
+ * @return NULL on error, else hashes to be destroyed with ljson_hashes_destroy
+ */
+ljson_hashes_t *ljson_hash(const ljson_item_t *item);
+
+/**
+ * De-allocate hashes created by ljson_hash.
+ * 
+ * @param hashes Hashes to destroy, may be NULL
+ */
+void ljson_hashes_destroy(ljson_hashes_t *hashes);
+
+/**
+ * Compute the changes turning one value into another from their hashes. If
+ * the values are equal, only their root hashes are compared. @see ljson_diff
+ * 
+ * @param a Hashes of original value
+ * @param b Hashes of changed value
+ * 
+ * @return NULL on error, else patch document to be destroyed with
+ *         ljson_destroy
+ */
+ljson_t *ljson_diff_hashed(const ljson_hashes_t *a, const ljson_hashes_t *b);
+
+/**
+ * Apply a JSON Merge Patch (RFC 7386) to a document, in place. @see
+ * ljson_item_set regarding storage of modified documents.
+ * 
+ * @param base Document to modify
+ * @param patch Merge patch to apply, must not be part of base
+ * 
+ * @return 0 on success, else -1. base may be partially modified on error.
+ */
+int ljson_merge(ljson_t *base, const ljson_item_t *patch);
+
+/**
+ * Wrap a document in a reference-counted handle, so it can be shared between
+ * threads. The document must no longer be modified. @see ljson_slot_t
+ * 
+ * @param json Document to share, destroyed along with the last reference
+ * 
+ * @return NULL on error, else handle holding one reference. json is left
+ *         alone on error.
+ */
+ljson_shared_t *ljson_shared_create(ljson_t *json);
+
+/**
+ * Take another reference to a shared document. The caller must already hold
+ * one.
+ * 
+ * @param shared Shared document
+ * 
+ * @return shared
+ */
+ljson_shared_t *ljson_shared_ref(ljson_shared_t *shared);
+
+/**
+ * Drop a reference to a shared document, destroying it if it was the last.
+ * 
+ * @param shared Shared document, may be NULL
+ */
+void ljson_shared_unref(ljson_shared_t *shared);
+
+/**
+ * Get the document behind a shared handle, only to be read from. It remains
+ * valid as long as a reference to shared is held.
+ * 
+ * @param shared Shared document
+ * 
+ * @return Shared document
+ */
+ljson_t *ljson_shared_doc(const ljson_shared_t *shared);
+
+/*
+ * Document publishing:
+ *
+ * A slot holds the current version of a shared document, for example a
+ * configuration file that gets reloaded. Readers take a reference to the
+ * current version with ljson_slot_acquire, without locking or waiting on
+ * publishers. A publisher replacing the document only waits for readers that
+ * are in the middle of ljson_slot_acquire, and the previous version is
+ * destroyed once the last reader drops its reference to it.
+ */
+
+/**
+ * Create a slot for publishing a shared document.
+ * 
+ * @param shared Initial document, may be NULL. The slot takes a reference of
+ *        its own.
+ * 
+ * @return NULL on error, else pointer to new slot
+ */
+ljson_slot_t *ljson_slot_create(ljson_shared_t *shared);
+
+/**
+ * Destroy a slot, dropping its reference to the current document. No thread
+ * may be using the slot anymore, though references acquired from it remain
+ * valid.
+ * 
+ * @param slot Slot to destroy
+ */
+void ljson_slot_destroy(ljson_slot_t *slot);
+
+/**
+ * Take a reference to the current document of a slot. This does not block.
+ * 
+ * @param slot Slot to read from
+ * 
+ * @return NULL if no document is published, else shared document, to be
+ *         released with ljson_shared_unref
+ */
+ljson_shared_t *ljson_slot_acquire(ljson_slot_t *slot);
+
+/**
+ * Replace the current document of a slot. Returns once no reader can acquire
+ * the previous document anymore, publishers are serialized.
+ * 
+ * @param slot Slot to publish to
+ * @param shared New document, may be NULL. The slot takes a reference of its
+ *        own.
+ */
+void ljson_slot_publish(ljson_slot_t *slot, ljson_shared_t *shared);
+
+/**
+ * Get the value of an integer, or of a raw number holding an integer.
+ * 
+ * @param item Item to convert
+ * @param value Where to store the value
+ * 
+ * @return 0 on success, -1 if item is not an integer or does not fit
+ */
+int ljson_number_int(const ljson_item_t *item, LJSON_INTTYPE *value);
+
+/**
+ * Get the value of any number as floating-point.
+ * 
+ * @param item Item to convert
+ * @param value Where to store the value
+ * 
+ * @return 0 on success, -1 if item is not a number
+ */
+int ljson_number_float(const ljson_item_t *item, LJSON_FLOATTYPE *value);
+
 /**
  * Search for item corresponding to the given key within a map, and check if it's
  * of the expected type. @see ljson_map_search
@@ -0,0 +1,378 @@
+#include <sys/mman.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "lambda-json.h"
+#include "ljson_internal.h"
+
+/*
+ * Binary image layout:
+ *
+ *   ljson_binhdr_t
+ *   Node section:   ljson_t, then every array and map in depth-first order,
+ *                   each aligned to LJSON_BIN_ALIGN
+ *   String section: NUL-terminated strings and keys
+ *
+ * Pointers within the image hold offsets from the start of the image, which
+ * are relocated once on load. The node section is validated while doing so,
+ * every container must start exactly where the previous one ended, so no node
+ * can be shared or reached twice, and every page of the node section is
+ * written to. Strings are only bounds-checked against the string section,
+ * which must end in a NUL, so relocation does not read them. The checksum
+ * does, unless LJSON_PARSEFLAG_NOCHECKSUM is given.
+ */
+
+#define LJSON_BIN_MAGIC     "LJSB"
+#define LJSON_BIN_VERSION   2
+#define LJSON_BIN_BYTEORDER 0x01020304UL
+#define LJSON_BIN_ALIGN     ((size_t)LJSON_CTX_ALIGN)
+
+#define LJSON_BIN_PAD(X) (((X) + (LJSON_BIN_ALIGN - 1)) & ~(LJSON_BIN_ALIGN - 1))
+
+typedef struct {
+    char     magic[4];   /** LJSON_BIN_MAGIC */
+    uint16_t version;    /** LJSON_BIN_VERSION */
+    uint8_t  int_size;   /** sizeof(LJSON_INTTYPE) */
+    uint8_t  float_size; /** sizeof(LJSON_FLOATTYPE) */
+    uint8_t  ptr_size;   /** sizeof(void *) */
+    uint8_t  item_size;  /** sizeof(ljson_item_t) */
+    uint16_t reserved;
+    uint32_t byte_order; /** LJSON_BIN_BYTEORDER, as stored by the writer */
+    uint64_t checksum;   /** FNV-1a of everything following the header */
+    uint64_t node_size;  /** Size of node section */
+    uint64_t str_size;   /** Size of string section */
+} ljson_binhdr_t;
+
+/** Offset of the node section, and of the ljson_t within it */
+#define LJSON_BIN_NODES LJSON_BIN_PAD(sizeof(ljson_binhdr_t))
+
+typedef struct {
+    uint8_t *image;    /** Image being written */
+    size_t   node_off; /** Offset of next container */
+    size_t   str_off;  /** Offset of next string */
+} ljson_binwriter_t;
+
+typedef struct {
+    uint8_t *image;     /** Image being relocated */
+    size_t   node_next; /** Offset at which the next container must start */
+    size_t   node_end;  /** End of node section */
+    size_t   str_start; /** Start of string section */
+    size_t   str_end;   /** End of string section */
+} ljson_binloader_t;
+
+static uint64_t _ljson_bin_checksum(const uint8_t *data, size_t len) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for(size_t i = 0; i < len; i++) {
+        hash ^= data[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+static void _ljson_bin_size(const ljson_item_t *item, size_t *nodes, size_t *strs) {
+    switch(item->type) {
+        case LJSON_ITEMTYPE_STRING:
+        case LJSON_ITEMTYPE_RAWNUMBER:
+            *strs += strlen(item->str) + 1;
+            break;
+
+        case LJSON_ITEMTYPE_ARRAY:
+            *nodes += LJSON_BIN_PAD(sizeof(ljson_array_t) + (item->array->count * sizeof(ljson_item_t)));
+            for(uint16_t i = 0; i < item->array->count; i++) {
+                _ljson_bin_size(&item->array->items[i], nodes, strs);
+            }
+            break;
+
+        case LJSON_ITEMTYPE_MAP:
+            *nodes += LJSON_BIN_PAD(sizeof(ljson_map_t) + (item->map->count * sizeof(ljson_mapitem_t)));
+            for(uint16_t i = 0; i < item->map->count; i++) {
+                *strs += strlen(item->map->items[i].name) + 1;
+                _ljson_bin_size(&item->map->items[i].item, nodes, strs);
+            }
+            break;
+
+        case LJSON_ITEMTYPE_NONE:
+        case LJSON_ITEMTYPE_NULL:
+        case LJSON_ITEMTYPE_BOOLEAN:
+        case LJSON_ITEMTYPE_INTEGER:
+        case LJSON_ITEMTYPE_FLOAT:
+            break;
+    }
+}
+
+/**
+ * Copy string into the string section, returning its offset in place of a
+ * pointer.
+ */
+static char *_ljson_bin_write_str(ljson_binwriter_t *writer, const char *str) {
+    size_t off = writer->str_off;
+    size_t len = strlen(str) + 1;
+    memcpy(&writer->image[off], str, len);
+    writer->str_off += len;
+    return (char *)(uintptr_t)off;
+}
+
+/**
+ * Write item into its place in the image, and anything it refers to into the
+ * next free space. Members are copied individually, so padding stays zeroed.
+ */
+static void _ljson_bin_write_item(ljson_binwriter_t *writer, ljson_item_t *dst, const ljson_item_t *src) {
+    dst->type = src->type;
+
+    switch(src->type) {
+        case LJSON_ITEMTYPE_STRING:
+        case LJSON_ITEMTYPE_RAWNUMBER:
+            dst->str = _ljson_bin_write_str(writer, src->str);
+            break;
+
+        case LJSON_ITEMTYPE_BOOLEAN:
+            dst->boolean = src->boolean;
+            break;
+
+        case LJSON_ITEMTYPE_INTEGER:
+            dst->integer = src->integer;
+            break;
+
+        case LJSON_ITEMTYPE_FLOAT:
+            dst->flt = src->flt;
+            break;
+
+        case LJSON_ITEMTYPE_ARRAY: {
+            size_t         off   = writer->node_off;
+            ljson_array_t *array = (ljson_array_t *)&writer->image[off];
+            array->count    = src->array->count;
+            array->capacity = array->count;
+            writer->node_off += LJSON_BIN_PAD(sizeof(ljson_array_t) + (array->count * sizeof(ljson_item_t)));
+            dst->array = (ljson_array_t *)(uintptr_t)off;
+            for(uint16_t i = 0; i < array->count; i++) {
+                _ljson_bin_write_item(writer, &array->items[i], &src->array->items[i]);
+            }
+        } break;
+
+        case LJSON_ITEMTYPE_MAP: {
+            size_t       off = writer->node_off;
+            ljson_map_t *map = (ljson_map_t *)&writer->image[off];
+            map->count    = src->map->count;
+            map->capacity = map->count;
+            writer->node_off += LJSON_BIN_PAD(sizeof(ljson_map_t) + (map->count * sizeof(ljson_mapitem_t)));
+            dst->map = (ljson_map_t *)(uintptr_t)off;
+            for(uint16_t i = 0; i < map->count; i++) {
+                map->items[i].name = _ljson_bin_write_str(writer, src->map->items[i].name);
+                _ljson_bin_write_item(writer, &map->items[i].item, &src->map->items[i].item);
+            }
+        } break;
+
+        case LJSON_ITEMTYPE_NONE:
+        case LJSON_ITEMTYPE_NULL:
+            break;
+    }
+}
+
+int ljson_save_binary(const ljson_t *json, const char *path) {
+    size_t nodes = LJSON_BIN_PAD(sizeof(ljson_t));
+    size_t strs  = 0;
+    _ljson_bin_size(&json->root, &nodes, &strs);
+
+    size_t   len   = LJSON_BIN_NODES + nodes + strs;
+    uint8_t *image = (uint8_t *)calloc(1, len);
+    if(!image) {
+        return -1;
+    }
+
+    ljson_binwriter_t writer = {
+        .image    = image,
+        .node_off = LJSON_BIN_NODES + LJSON_BIN_PAD(sizeof(ljson_t)),
+        .str_off  = LJSON_BIN_NODES + nodes
+    };
+    ljson_t *dst = (ljson_t *)&image[LJSON_BIN_NODES];
+    _ljson_bin_write_item(&writer, &dst->root, &json->root);
+
+    ljson_binhdr_t *hdr = (ljson_binhdr_t *)image;
+    memcpy(hdr->magic, LJSON_BIN_MAGIC, sizeof(hdr->magic));
+    hdr->version    = LJSON_BIN_VERSION;
+    hdr->int_size   = sizeof(LJSON_INTTYPE);
+    hdr->float_size = sizeof(LJSON_FLOATTYPE);
+    hdr->ptr_size   = sizeof(void *);
+    hdr->item_size  = sizeof(ljson_item_t);
+    hdr->byte_order = LJSON_BIN_BYTEORDER;
+    hdr->node_size  = nodes;
+    hdr->str_size   = strs;
+    hdr->checksum   = _ljson_bin_checksum(&image[LJSON_BIN_NODES], len - LJSON_BIN_NODES);
+
+    int   ret = -1;
+    FILE *fp  = fopen(path, "wb");
+    if(fp) {
+        if(fwrite(image, 1, len, fp) == len) {
+            ret = 0;
+        }
+        if(fclose(fp)) {
+            ret = -1;
+        }
+    }
+
+    free(image);
+    return ret;
+}
+
+static int _ljson_bin_reloc_str(const ljson_binloader_t *loader, char **str) {
+    uintptr_t off = (uintptr_t)*str;
+    if((off < loader->str_start) ||
+       (off >= loader->str_end)) {
+        return -1;
+    }
+    *str = (char *)&loader->image[off];
+    return 0;
+}
+
+/**
+ * Relocate pointer to a container, which must start at the next free offset
+ * of the node section.
+ *
+ * @return NULL on error, else pointer to container
+ */
+static void *_ljson_bin_reloc_node(ljson_binloader_t *loader, const void *ptr, size_t hdr_size, size_t el_size) {
+    uintptr_t off = (uintptr_t)ptr;
+    if((off != loader->node_next) ||
+       ((loader->node_end - off) < hdr_size)) {
+        return NULL;
+    }
+
+    /* Both ljson_array_t and ljson_map_t start with their count and
+     * capacity. Containers are stored without room to spare. */
+    const uint16_t *counts = (const uint16_t *)&loader->image[off];
+    size_t          size   = hdr_size + (counts[0] * el_size);
+    if((counts[1] != counts[0]) ||
+       ((loader->node_end - off) < size)) {
+        return NULL;
+    }
+
+    loader->node_next = off + LJSON_BIN_PAD(size);
+    return &loader->image[off];
+}
+
+static int _ljson_bin_reloc_item(ljson_binloader_t *loader, ljson_item_t *item) {
+    switch(item->type) {
+        case LJSON_ITEMTYPE_NONE:
+        case LJSON_ITEMTYPE_NULL:
+        case LJSON_ITEMTYPE_BOOLEAN:
+        case LJSON_ITEMTYPE_INTEGER:
+        case LJSON_ITEMTYPE_FLOAT:
+            return 0;
+
+        case LJSON_ITEMTYPE_STRING:
+        case LJSON_ITEMTYPE_RAWNUMBER:
+            return _ljson_bin_reloc_str(loader, &item->str);
+
+        case LJSON_ITEMTYPE_ARRAY:
+            item->array = (ljson_array_t *)_ljson_bin_reloc_node(loader, item->array, sizeof(ljson_array_t), sizeof(ljson_item_t));
+            if(!item->array) {
+                return -1;
+            }
+            for(uint16_t i = 0; i < item->array->count; i++) {
+                if(_ljson_bin_reloc_item(loader, &item->array->items[i])) {
+                    return -1;
+                }
+            }
+            return 0;
+
+        case LJSON_ITEMTYPE_MAP:
+            item->map = (ljson_map_t *)_ljson_bin_reloc_node(loader, item->map, sizeof(ljson_map_t), sizeof(ljson_mapitem_t));
+            if(!item->map) {
+                return -1;
+            }
+            for(uint16_t i = 0; i < item->map->count; i++) {
+                if(_ljson_bin_reloc_str(loader, &item->map->items[i].name) ||
+                   _ljson_bin_reloc_item(loader, &item->map->items[i].item)) {
+                    return -1;
+                }
+            }
+            return 0;
+    }
+
+    /* Not a valid item type */
+    return -1;
+}
+
+static int _ljson_bin_check_header(const uint8_t *image, size_t len, uint32_t flags) {
+    if(len < LJSON_BIN_NODES + LJSON_BIN_PAD(sizeof(ljson_t))) {
+        return -1;
+    }
+
+    const ljson_binhdr_t *hdr = (const ljson_binhdr_t *)image;
+    if(memcmp(hdr->magic, LJSON_BIN_MAGIC, sizeof(hdr->magic)) ||
+       (hdr->version    != LJSON_BIN_VERSION)         ||
+       (hdr->int_size   != sizeof(LJSON_INTTYPE))     ||
+       (hdr->float_size != sizeof(LJSON_FLOATTYPE))   ||
+       (hdr->ptr_size   != sizeof(void *))            ||
+       (hdr->item_size  != sizeof(ljson_item_t))      ||
+       (hdr->byte_order != LJSON_BIN_BYTEORDER)) {
+        /* Not an image, or written by an incompatible build */
+        return -1;
+    }
+
+    if((hdr->node_size > len) ||
+       (hdr->str_size  > len) ||
+       ((LJSON_BIN_NODES + hdr->node_size + hdr->str_size) != len) ||
+       (hdr->node_size < LJSON_BIN_PAD(sizeof(ljson_t))) ||
+       (hdr->node_size != LJSON_BIN_PAD(hdr->node_size))) {
+        return -1;
+    }
+
+    if(hdr->str_size && (image[len - 1] != '\0')) {
+        /* Last string must be terminated within the image */
+        return -1;
+    }
+
+    if(!(flags & LJSON_PARSEFLAG_NOCHECKSUM) &&
+       (hdr->checksum != _ljson_bin_checksum(&image[LJSON_BIN_NODES], len - LJSON_BIN_NODES))) {
+        return -1;
+    }
+
+    return 0;
+}
+
+ljson_t *ljson_load_binary(const char *path, uint32_t flags) {
+    size_t   len;
+    uint8_t *image = (uint8_t *)_ljson_file_map(path, 1, flags, &len);
+    if(!image) {
+        return NULL;
+    }
+
+    /* Only used if the document is later modified */
+    ljson_ctx_t *ctx = ljson_ctx_create(0);
+    if(!ctx) {
+        munmap(image, len);
+        return NULL;
+    }
+    ctx->map     = image;
+    ctx->map_len = len;
+
+    if(_ljson_bin_check_header(image, len, flags)) {
+        ljson_ctx_destroy(ctx);
+        return NULL;
+    }
+
+    const ljson_binhdr_t *hdr = (const ljson_binhdr_t *)image;
+    ljson_binloader_t loader = {
+        .image     = image,
+        .node_next = LJSON_BIN_NODES + LJSON_BIN_PAD(sizeof(ljson_t)),
+        .node_end  = LJSON_BIN_NODES + hdr->node_size,
+        .str_start = LJSON_BIN_NODES + hdr->node_size,
+        .str_end   = len
+    };
+
+    ljson_t *json = (ljson_t *)&image[LJSON_BIN_NODES];
+    if(_ljson_bin_reloc_item(&loader, &json->root) ||
+       (loader.node_next != loader.node_end)) {
+        ljson_ctx_destroy(ctx);
+        return NULL;
+    }
+    json->ctx  = ctx;
+    ctx->owner = json;
+
+    /* Lookups from here on are not sequential */
+    (void)madvise(image, len, MADV_NORMAL);
+
+    return json;
+}
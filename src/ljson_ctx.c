@@ -0,0 +1,127 @@
+#include <stdlib.h>
+#include <sys/mman.h>
+
+#include "ljson_internal.h"
+
+static ljson_ctx_block_t *_ljson_ctx_block_new(size_t size) {
+    ljson_ctx_block_t *block = (ljson_ctx_block_t *)malloc(sizeof(ljson_ctx_block_t) + size);
+    if(!block) {
+        return NULL;
+    }
+
+    block->next = NULL;
+    block->size = size;
+    block->used = 0;
+
+    return block;
+}
+
+ljson_ctx_t *ljson_ctx_create(size_t size) {
+    ljson_ctx_t *ctx = (ljson_ctx_t *)malloc(sizeof(ljson_ctx_t));
+    if(!ctx) {
+        return NULL;
+    }
+
+    ctx->blocks = _ljson_ctx_block_new(size ? size : LJSON_CTX_DEFSIZE);
+    if(!ctx->blocks) {
+        free(ctx);
+        return NULL;
+    }
+
+    ctx->owner   = NULL;
+    ctx->map     = NULL;
+    ctx->map_len = 0;
+
+    return ctx;
+}
+
+void ljson_ctx_reset(ljson_ctx_t *ctx) {
+    ljson_ctx_block_t *block = ctx->blocks;
+
+    if(block && !block->next) {
+        /* Steady state: a single block, large enough for previous documents */
+        block->used = 0;
+        return;
+    }
+
+    /* The last document outgrew the first block. Replace every block with
+     * one block large enough to hold all of them, so the next document of
+     * similar shape fits without further allocations. */
+    size_t total = 0;
+    while(block) {
+        ljson_ctx_block_t *next = block->next;
+        total += block->size;
+        free(block);
+        block = next;
+    }
+
+    ctx->blocks = _ljson_ctx_block_new(total ? total : LJSON_CTX_DEFSIZE);
+}
+
+void ljson_ctx_destroy(ljson_ctx_t *ctx) {
+    if(ctx->map) {
+        munmap(ctx->map, ctx->map_len);
+    }
+
+    ljson_ctx_block_t *block = ctx->blocks;
+    while(block) {
+        ljson_ctx_block_t *next = block->next;
+        free(block);
+        block = next;
+    }
+    free(ctx);
+}
+
+/**
+ * Allocate size bytes from the context, at a multiple of align, which must be
+ * a power of two no larger than LJSON_CTX_ALIGN.
+ */
+static void *_ljson_ctx_alloc(ljson_ctx_t *ctx, size_t size, size_t align) {
+    ljson_ctx_block_t *block = ctx->blocks;
+    size_t             start = block ? ((block->used + (align - 1)) & ~(align - 1)) : 0;
+
+    if(!block || (start > block->size) || ((block->size - start) < size)) {
+        size_t bsize = block ? (block->size * 2) : LJSON_CTX_DEFSIZE;
+        if(bsize < size) {
+            bsize = size;
+        }
+
+        block = _ljson_ctx_block_new(bsize);
+        if(!block) {
+            return NULL;
+        }
+        block->next = ctx->blocks;
+        ctx->blocks = block;
+        start       = 0;
+    }
+
+    void *ptr = (char *)block->data + start;
+    block->used = start + size;
+
+    return ptr;
+}
+
+void *_ljson_alloc(ljson_ctx_t *ctx, size_t size) {
+    if(!ctx) {
+        return malloc(size);
+    }
+
+    /* Keep every allocation suitably aligned for any member type */
+    return _ljson_ctx_alloc(ctx, size, LJSON_CTX_ALIGN);
+}
+
+void *_ljson_alloc_str(ljson_ctx_t *ctx, size_t size) {
+    if(!ctx) {
+        return malloc(size);
+    }
+
+    /* Strings are packed back to back, short keys would mostly be padding
+     * otherwise */
+    return _ljson_ctx_alloc(ctx, size, 1);
+}
+
+void _ljson_free(ljson_ctx_t *ctx, void *ptr) {
+    if(!ctx) {
+        free(ptr);
+    }
+}
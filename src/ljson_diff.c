@@ -0,0 +1,485 @@
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "lambda-json.h"
+#include "ljson_internal.h"
+
+/*
+ * Diffing works on trees of content hashes mirroring each document, so that
+ * identical subtrees are skipped by comparing a single hash. Hash trees are
+ * kept apart from the documents, in storage of their own, so hashing never
+ * modifies a document, and a caller can keep the tree of a base document to
+ * diff many versions against. Map keys are matched through a hash table
+ * built per map, rather than searching one map for every key of the other.
+ */
+
+typedef struct ljson_hashnode_struct ljson_hashnode_t;
+
+/**
+ * Content hash of an item, and of everything below it */
+struct ljson_hashnode_struct {
+    uint64_t          hash;     /** Hash of item's content */
+    uint64_t          keyhash;  /** Hash of item's key, if it is a map value */
+    ljson_hashnode_t *children; /** Hashes of array items or map values */
+};
+
+/**
+ * Hash tree of an item */
+struct ljson_hashes_struct {
+    const ljson_item_t *item; /** Item the tree was built from */
+    ljson_ctx_t        *ctx;  /** Storage of the tree, including this struct */
+    ljson_hashnode_t    root; /** Hash of item */
+};
+
+typedef struct {
+    ljson_ctx_t *scratch;  /** Storage for key tables, created on first use */
+    ljson_t     *patch;    /** Patch being built */
+    char        *path;     /** JSON Pointer to the items being compared */
+    size_t       path_len; /** Length of path */
+    size_t       path_cap; /** Size of path buffer */
+} ljson_differ_t;
+
+static const ljson_item_t _empty_map   = { .type = LJSON_ITEMTYPE_MAP };
+static const ljson_item_t _empty_array = { .type = LJSON_ITEMTYPE_ARRAY };
+static const ljson_item_t _null        = { .type = LJSON_ITEMTYPE_NULL };
+
+/**
+ * Finalizer from splitmix64, spreading every input bit over the output.
+ */
+static uint64_t _ljson_mix(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+static uint64_t _ljson_strhash(const char *str) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    while(*str) {
+        hash ^= (uint8_t)*str++;
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+static int _ljson_hash(ljson_ctx_t *scratch, const ljson_item_t *item, ljson_hashnode_t *node) {
+    uint64_t hash = _ljson_mix((uint64_t)item->type + 1);
+    node->children = NULL;
+
+    switch(item->type) {
+        case LJSON_ITEMTYPE_NONE:
+        case LJSON_ITEMTYPE_NULL:
+            break;
+
+        case LJSON_ITEMTYPE_BOOLEAN:
+            hash ^= _ljson_mix((uint64_t)item->boolean);
+            break;
+
+        case LJSON_ITEMTYPE_INTEGER:
+            hash ^= _ljson_mix((uint64_t)item->integer);
+            break;
+
+        case LJSON_ITEMTYPE_FLOAT: {
+            double   flt = (double)item->flt;
+            uint64_t bits;
+            memcpy(&bits, &flt, sizeof(bits));
+            hash ^= _ljson_mix(bits);
+        } break;
+
+        case LJSON_ITEMTYPE_STRING:
+        case LJSON_ITEMTYPE_RAWNUMBER:
+            hash ^= _ljson_strhash(item->str);
+            break;
+
+        case LJSON_ITEMTYPE_ARRAY:
+            node->children = (ljson_hashnode_t *)_ljson_alloc(scratch, item->array->count * sizeof(ljson_hashnode_t));
+            if(!node->children) {
+                return -1;
+            }
+            for(uint16_t i = 0; i < item->array->count; i++) {
+                if(_ljson_hash(scratch, &item->array->items[i], &node->children[i])) {
+                    return -1;
+                }
+                /* Order matters */
+                hash = _ljson_mix(hash ^ node->children[i].hash);
+            }
+            break;
+
+        case LJSON_ITEMTYPE_MAP: {
+            node->children = (ljson_hashnode_t *)_ljson_alloc(scratch, item->map->count * sizeof(ljson_hashnode_t));
+            if(!node->children) {
+                return -1;
+            }
+            uint64_t sum = 0;
+            for(uint16_t i = 0; i < item->map->count; i++) {
+                ljson_hashnode_t *child = &node->children[i];
+                if(_ljson_hash(scratch, &item->map->items[i].item, child)) {
+                    return -1;
+                }
+                child->keyhash = _ljson_strhash(item->map->items[i].name);
+                /* Order does not matter */
+                sum += _ljson_mix(child->keyhash ^ (child->hash * 0x9e3779b97f4a7c15ULL));
+            }
+            hash ^= _ljson_mix(sum);
+        } break;
+    }
+
+    node->hash = hash;
+    return 0;
+}
+
+/**
+ * Compare two items with equal hashes that are not arrays or maps, in case
+ * the hashes collide. Floats are compared by representation, as when hashed.
+ */
+static int _ljson_leaf_equal(const ljson_item_t *a, const ljson_item_t *b) {
+    if(a->type != b->type) {
+        return 0;
+    }
+
+    switch(a->type) {
+        case LJSON_ITEMTYPE_NONE:
+        case LJSON_ITEMTYPE_NULL:
+            return 1;
+
+        case LJSON_ITEMTYPE_BOOLEAN:
+            return a->boolean == b->boolean;
+
+        case LJSON_ITEMTYPE_INTEGER:
+            return a->integer == b->integer;
+
+        case LJSON_ITEMTYPE_FLOAT:
+            return !memcmp(&a->flt, &b->flt, sizeof(a->flt));
+
+        case LJSON_ITEMTYPE_STRING:
+        case LJSON_ITEMTYPE_RAWNUMBER:
+            return !strcmp(a->str, b->str);
+
+        case LJSON_ITEMTYPE_ARRAY:
+        case LJSON_ITEMTYPE_MAP:
+            break;
+    }
+
+    return 0;
+}
+
+/**
+ * Append a segment to the current path, escaping it as per RFC 6901.
+ *
+ * @return Previous length of path, to be restored with _ljson_path_pop, or
+ *         -1 on error
+ */
+static long _ljson_path_push(ljson_differ_t *differ, const char *seg) {
+    size_t len = 1;
+    for(const char *ch = seg; *ch; ch++) {
+        len += ((*ch == '~') || (*ch == '/')) ? 2 : 1;
+    }
+
+    if((differ->path_len + len + 1) > differ->path_cap) {
+        size_t cap  = (differ->path_cap + len + 1) * 2;
+        char  *path = (char *)realloc(differ->path, cap);
+        if(!path) {
+            return -1;
+        }
+        differ->path     = path;
+        differ->path_cap = cap;
+    }
+
+    long  prev = (long)differ->path_len;
+    char *out  = &differ->path[differ->path_len];
+    *out++ = '/';
+    for(const char *ch = seg; *ch; ch++) {
+        if(*ch == '~') {
+            *out++ = '~';
+            *out++ = '0';
+        } else if(*ch == '/') {
+            *out++ = '~';
+            *out++ = '1';
+        } else {
+            *out++ = *ch;
+        }
+    }
+    *out = '\0';
+    differ->path_len += len;
+
+    return prev;
+}
+
+static long _ljson_path_push_index(ljson_differ_t *differ, uint16_t index) {
+    char seg[8];
+    snprintf(seg, sizeof(seg), "%u", (unsigned)index);
+    return _ljson_path_push(differ, seg);
+}
+
+static void _ljson_path_pop(ljson_differ_t *differ, long prev) {
+    differ->path_len = (size_t)prev;
+    differ->path[prev] = '\0';
+}
+
+/**
+ * Add an operation on the current path to the patch.
+ */
+static int _ljson_diff_op(ljson_differ_t *differ, char *op, const ljson_item_t *value) {
+    ljson_t      *patch = differ->patch;
+    ljson_item_t *entry = ljson_array_append(patch, &patch->root, &_empty_map);
+    if(!entry) {
+        return -1;
+    }
+
+    ljson_item_t opitem   = { .type = LJSON_ITEMTYPE_STRING, .str = op };
+    ljson_item_t pathitem = { .type = LJSON_ITEMTYPE_STRING, .str = differ->path };
+    if(!ljson_map_set(patch, entry, "op",   &opitem) ||
+       !ljson_map_set(patch, entry, "path", &pathitem)) {
+        return -1;
+    }
+    if(value && !ljson_map_set(patch, entry, "value", value)) {
+        return -1;
+    }
+
+    return 0;
+}
+
+static int _ljson_diff_item(ljson_differ_t *, const ljson_item_t *, const ljson_hashnode_t *,
+                            const ljson_item_t *, const ljson_hashnode_t *);
+
+static int _ljson_diff_array(ljson_differ_t *differ,
+                             const ljson_array_t *a, const ljson_hashnode_t *ha,
+                             const ljson_array_t *b, const ljson_hashnode_t *hb) {
+    uint16_t common = (a->count < b->count) ? a->count : b->count;
+    long     prev;
+
+    for(uint16_t i = 0; i < common; i++) {
+        if((prev = _ljson_path_push_index(differ, i)) < 0 ||
+           _ljson_diff_item(differ, &a->items[i], &ha->children[i], &b->items[i], &hb->children[i])) {
+            return -1;
+        }
+        _ljson_path_pop(differ, prev);
+    }
+
+    for(uint16_t i = common; i < b->count; i++) {
+        if((prev = _ljson_path_push_index(differ, i)) < 0 ||
+           _ljson_diff_op(differ, "add", &b->items[i])) {
+            return -1;
+        }
+        _ljson_path_pop(differ, prev);
+    }
+
+    /* Remove from the end, so earlier indices stay valid */
+    for(uint16_t i = a->count; i > common; i--) {
+        if((prev = _ljson_path_push_index(differ, (uint16_t)(i - 1))) < 0 ||
+           _ljson_diff_op(differ, "remove", NULL)) {
+            return -1;
+        }
+        _ljson_path_pop(differ, prev);
+    }
+
+    return 0;
+}
+
+static int _ljson_diff_map(ljson_differ_t *differ,
+                           const ljson_map_t *a, const ljson_hashnode_t *ha,
+                           const ljson_map_t *b, const ljson_hashnode_t *hb) {
+    if(!differ->scratch && !(differ->scratch = ljson_ctx_create(0))) {
+        return -1;
+    }
+
+    /* Open-addressed table of b's keys, holding index + 1 */
+    size_t size = 4;
+    while(size < ((size_t)b->count * 2)) {
+        size *= 2;
+    }
+    uint32_t *table   = (uint32_t *)_ljson_alloc(differ->scratch, size * sizeof(uint32_t));
+    uint8_t  *matched = (uint8_t *)_ljson_alloc(differ->scratch, b->count);
+    if(!table || !matched) {
+        return -1;
+    }
+    memset(table,   0, size * sizeof(uint32_t));
+    memset(matched, 0, b->count);
+
+    for(uint16_t j = 0; j < b->count; j++) {
+        size_t slot = hb->children[j].keyhash & (size - 1);
+        while(table[slot]) {
+            slot = (slot + 1) & (size - 1);
+        }
+        table[slot] = (uint32_t)j + 1;
+    }
+
+    long prev;
+    for(uint16_t i = 0; i < a->count; i++) {
+        const char *name  = a->items[i].name;
+        size_t      slot  = ha->children[i].keyhash & (size - 1);
+        int         found = -1;
+        while(table[slot]) {
+            uint32_t j = table[slot] - 1;
+            if((hb->children[j].keyhash == ha->children[i].keyhash) &&
+               !strcmp(b->items[j].name, name)) {
+                found = (int)j;
+                break;
+            }
+            slot = (slot + 1) & (size - 1);
+        }
+
+        if((prev = _ljson_path_push(differ, name)) < 0) {
+            return -1;
+        }
+        if(found < 0) {
+            if(_ljson_diff_op(differ, "remove", NULL)) {
+                return -1;
+            }
+        } else {
+            matched[found] = 1;
+            if(_ljson_diff_item(differ, &a->items[i].item, &ha->children[i],
+                                &b->items[found].item, &hb->children[found])) {
+                return -1;
+            }
+        }
+        _ljson_path_pop(differ, prev);
+    }
+
+    for(uint16_t j = 0; j < b->count; j++) {
+        if(matched[j]) {
+            continue;
+        }
+        if((prev = _ljson_path_push(differ, b->items[j].name)) < 0 ||
+           _ljson_diff_op(differ, "add", &b->items[j].item)) {
+            return -1;
+        }
+        _ljson_path_pop(differ, prev);
+    }
+
+    return 0;
+}
+
+static int _ljson_diff_item(ljson_differ_t *differ,
+                            const ljson_item_t *a, const ljson_hashnode_t *ha,
+                            const ljson_item_t *b, const ljson_hashnode_t *hb) {
+    int isarray = (a->type == LJSON_ITEMTYPE_ARRAY) && (b->type == LJSON_ITEMTYPE_ARRAY);
+    int ismap   = (a->type == LJSON_ITEMTYPE_MAP)   && (b->type == LJSON_ITEMTYPE_MAP);
+
+    if(ha->hash == hb->hash) {
+        /* Identical content. Containers are taken on their hash alone, so
+         * equal subtrees are not walked, leaves are cheap to confirm. */
+        if(isarray || ismap || _ljson_leaf_equal(a, b)) {
+            return 0;
+        }
+    }
+
+    if(isarray) {
+        return _ljson_diff_array(differ, a->array, ha, b->array, hb);
+    }
+    if(ismap) {
+        return _ljson_diff_map(differ, a->map, ha, b->map, hb);
+    }
+
+    return _ljson_diff_op(differ, "replace", b);
+}
+
+ljson_hashes_t *ljson_hash(const ljson_item_t *item) {
+    ljson_ctx_t *ctx = ljson_ctx_create(0);
+    if(!ctx) {
+        return NULL;
+    }
+
+    ljson_hashes_t *hashes = (ljson_hashes_t *)_ljson_alloc(ctx, sizeof(ljson_hashes_t));
+    if(!hashes ||
+       _ljson_hash(ctx, item, &hashes->root)) {
+        ljson_ctx_destroy(ctx);
+        return NULL;
+    }
+
+    hashes->item = item;
+    hashes->ctx  = ctx;
+
+    return hashes;
+}
+
+void ljson_hashes_destroy(ljson_hashes_t *hashes) {
+    if(hashes) {
+        ljson_ctx_destroy(hashes->ctx);
+    }
+}
+
+ljson_t *ljson_diff_hashed(const ljson_hashes_t *a, const ljson_hashes_t *b) {
+    ljson_t *patch = ljson_create(NULL);
+    if(!patch) {
+        return NULL;
+    }
+
+    ljson_differ_t differ = {
+        .scratch  = NULL,
+        .patch    = patch,
+        .path     = (char *)malloc(64),
+        .path_len = 0,
+        .path_cap = 64
+    };
+
+    int fail = (!differ.path ||
+                ljson_item_set(patch, &patch->root, &_empty_array));
+    if(!fail) {
+        differ.path[0] = '\0';
+        fail = _ljson_diff_item(&differ, a->item, &a->root, b->item, &b->root);
+    }
+
+    if(differ.scratch) {
+        ljson_ctx_destroy(differ.scratch);
+    }
+    free(differ.path);
+
+    if(fail) {
+        ljson_destroy(patch);
+        return NULL;
+    }
+
+    return patch;
+}
+
+ljson_t *ljson_diff(const ljson_item_t *a, const ljson_item_t *b) {
+    ljson_hashes_t *ha    = ljson_hash(a);
+    ljson_hashes_t *hb    = ljson_hash(b);
+    ljson_t        *patch = (ha && hb) ? ljson_diff_hashed(ha, hb) : NULL;
+
+    ljson_hashes_destroy(ha);
+    ljson_hashes_destroy(hb);
+
+    return patch;
+}
+
+static int _ljson_merge(ljson_t *json, ljson_item_t *target, const ljson_item_t *patch) {
+    if(patch->type != LJSON_ITEMTYPE_MAP) {
+        return ljson_item_set(json, target, patch);
+    }
+
+    if((target->type != LJSON_ITEMTYPE_MAP) &&
+       ljson_item_set(json, target, &_empty_map)) {
+        return -1;
+    }
+
+    for(uint16_t i = 0; i < patch->map->count; i++) {
+        const char         *name  = patch->map->items[i].name;
+        const ljson_item_t *value = &patch->map->items[i].item;
+
+        if(value->type == LJSON_ITEMTYPE_NULL) {
+            /* Absent keys are fine */
+            (void)ljson_map_remove(json, target, name);
+            continue;
+        }
+
+        ljson_item_t *dst = ljson_map_search(target->map, name);
+        if(!dst) {
+            /* Merging into null produces a copy of value, without any nulls */
+            dst = ljson_map_set(json, target, name, &_null);
+        }
+        if(!dst || _ljson_merge(json, dst, value)) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int ljson_merge(ljson_t *base, const ljson_item_t *patch) {
+    return _ljson_merge(base, &base->root, patch);
+}
@@ -0,0 +1,303 @@
+#include <string.h>
+#include <stdlib.h>
+
+#include "lambda-json.h"
+#include "ljson_internal.h"
+
+/** Capacity of an array or map when it first grows from empty */
+#define LJSON_EDIT_MINCAP 4
+
+static char *_ljson_strdup(ljson_ctx_t *ctx, const char *str) {
+    size_t len = strlen(str) + 1;
+    char  *dup = (char *)_ljson_alloc_str(ctx, len);
+    if(dup) {
+        memcpy(dup, str, len);
+    }
+    return dup;
+}
+
+int _ljson_item_copy(ljson_ctx_t *ctx, ljson_item_t *dst, const ljson_item_t *src) {
+    dst->type = src->type;
+
+    switch(src->type) {
+        case LJSON_ITEMTYPE_NONE:
+        case LJSON_ITEMTYPE_NULL:
+            return 0;
+
+        case LJSON_ITEMTYPE_BOOLEAN:
+            dst->boolean = src->boolean;
+            return 0;
+
+        case LJSON_ITEMTYPE_INTEGER:
+            dst->integer = src->integer;
+            return 0;
+
+        case LJSON_ITEMTYPE_FLOAT:
+            dst->flt = src->flt;
+            return 0;
+
+        case LJSON_ITEMTYPE_STRING:
+        case LJSON_ITEMTYPE_RAWNUMBER:
+            dst->str = _ljson_strdup(ctx, src->str);
+            return dst->str ? 0 : -1;
+
+        case LJSON_ITEMTYPE_ARRAY: {
+            uint16_t count = src->array ? src->array->count : 0;
+            dst->array = (ljson_array_t *)_ljson_alloc(ctx, sizeof(ljson_array_t) + ((size_t)count * sizeof(ljson_item_t)));
+            if(!dst->array) {
+                return -1;
+            }
+            dst->array->count    = 0;
+            dst->array->capacity = count;
+            for(uint16_t i = 0; i < count; i++) {
+                if(_ljson_item_copy(ctx, &dst->array->items[i], &src->array->items[i])) {
+                    _ljson_item_delete(ctx, dst);
+                    return -1;
+                }
+                /* We increment this one at a time, so delete can still work */
+                dst->array->count = (uint16_t)(i + 1);
+            }
+        } return 0;
+
+        case LJSON_ITEMTYPE_MAP: {
+            uint16_t count = src->map ? src->map->count : 0;
+            dst->map = (ljson_map_t *)_ljson_alloc(ctx, sizeof(ljson_map_t) + ((size_t)count * sizeof(ljson_mapitem_t)));
+            if(!dst->map) {
+                return -1;
+            }
+            dst->map->count    = 0;
+            dst->map->capacity = count;
+            for(uint16_t i = 0; i < count; i++) {
+                ljson_mapitem_t *mapitem = &dst->map->items[i];
+                mapitem->name = _ljson_strdup(ctx, src->map->items[i].name);
+                if(!mapitem->name) {
+                    _ljson_item_delete(ctx, dst);
+                    return -1;
+                }
+                if(_ljson_item_copy(ctx, &mapitem->item, &src->map->items[i].item)) {
+                    _ljson_free(ctx, mapitem->name);
+                    _ljson_item_delete(ctx, dst);
+                    return -1;
+                }
+                dst->map->count = (uint16_t)(i + 1);
+            }
+        } return 0;
+    }
+
+    return -1;
+}
+
+/**
+ * Returns the capacity to grow a container to, or 0 if it is full.
+ */
+static uint16_t _ljson_grow_capacity(uint16_t capacity) {
+    if(capacity == UINT16_MAX) {
+        return 0;
+    } else if(capacity < LJSON_EDIT_MINCAP) {
+        return LJSON_EDIT_MINCAP;
+    } else if(capacity > (UINT16_MAX / 2)) {
+        return UINT16_MAX;
+    }
+    return (uint16_t)(capacity * 2);
+}
+
+/**
+ * Make room for at least one more item in an array. Within a context, the
+ * array is moved to new storage, as context storage cannot be resized.
+ */
+static int _ljson_array_reserve(ljson_ctx_t *ctx, ljson_item_t *item) {
+    ljson_array_t *array = item->array;
+    if(array->count < array->capacity) {
+        return 0;
+    }
+
+    uint16_t capacity = _ljson_grow_capacity(array->capacity);
+    if(!capacity) {
+        return -1;
+    }
+
+    size_t size = sizeof(ljson_array_t) + ((size_t)capacity * sizeof(ljson_item_t));
+    if(ctx) {
+        array = (ljson_array_t *)_ljson_alloc(ctx, size);
+        if(!array) {
+            return -1;
+        }
+        memcpy(array, item->array, sizeof(ljson_array_t) + ((size_t)item->array->count * sizeof(ljson_item_t)));
+    } else {
+        array = (ljson_array_t *)realloc(array, size);
+        if(!array) {
+            return -1;
+        }
+    }
+
+    array->capacity = capacity;
+    item->array     = array;
+    return 0;
+}
+
+/**
+ * Make room for at least one more mapping in a map. @see _ljson_array_reserve
+ */
+static int _ljson_map_reserve(ljson_ctx_t *ctx, ljson_item_t *item) {
+    ljson_map_t *map = item->map;
+    if(map->count < map->capacity) {
+        return 0;
+    }
+
+    uint16_t capacity = _ljson_grow_capacity(map->capacity);
+    if(!capacity) {
+        return -1;
+    }
+
+    size_t size = sizeof(ljson_map_t) + ((size_t)capacity * sizeof(ljson_mapitem_t));
+    if(ctx) {
+        map = (ljson_map_t *)_ljson_alloc(ctx, size);
+        if(!map) {
+            return -1;
+        }
+        memcpy(map, item->map, sizeof(ljson_map_t) + ((size_t)item->map->count * sizeof(ljson_mapitem_t)));
+    } else {
+        map = (ljson_map_t *)realloc(map, size);
+        if(!map) {
+            return -1;
+        }
+    }
+
+    map->capacity = capacity;
+    item->map     = map;
+    return 0;
+}
+
+static int _ljson_map_index(const ljson_map_t *map, const char *key) {
+    for(uint16_t i = 0; i < map->count; i++) {
+        if(!strcmp(map->items[i].name, key)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+ljson_t *ljson_create(ljson_ctx_t *ctx) {
+    ljson_t *json = (ljson_t *)_ljson_alloc(ctx, sizeof(ljson_t));
+    if(!json) {
+        return NULL;
+    }
+
+    json->root.type = LJSON_ITEMTYPE_NULL;
+    json->ctx       = ctx;
+
+    return json;
+}
+
+int ljson_item_set(ljson_t *json, ljson_item_t *item, const ljson_item_t *value) {
+    /* Copy first, value may be part of item */
+    ljson_item_t copy;
+    if(_ljson_item_copy(json->ctx, &copy, value)) {
+        return -1;
+    }
+
+    _ljson_item_delete(json->ctx, item);
+    *item = copy;
+
+    return 0;
+}
+
+ljson_item_t *ljson_array_insert(ljson_t *json, ljson_item_t *array, uint16_t index, const ljson_item_t *value) {
+    if((array->type != LJSON_ITEMTYPE_ARRAY) ||
+       (index > array->array->count)) {
+        return NULL;
+    }
+
+    /* Copy first, value may be part of the array */
+    ljson_item_t copy;
+    if(_ljson_item_copy(json->ctx, &copy, value)) {
+        return NULL;
+    }
+
+    if(_ljson_array_reserve(json->ctx, array)) {
+        _ljson_item_delete(json->ctx, &copy);
+        return NULL;
+    }
+
+    ljson_item_t *items = array->array->items;
+    memmove(&items[index + 1], &items[index], (size_t)(array->array->count - index) * sizeof(ljson_item_t));
+    items[index] = copy;
+    array->array->count++;
+
+    return &items[index];
+}
+
+ljson_item_t *ljson_array_append(ljson_t *json, ljson_item_t *array, const ljson_item_t *value) {
+    if(array->type != LJSON_ITEMTYPE_ARRAY) {
+        return NULL;
+    }
+    return ljson_array_insert(json, array, array->array->count, value);
+}
+
+int ljson_array_remove(ljson_t *json, ljson_item_t *array, uint16_t index) {
+    if((array->type != LJSON_ITEMTYPE_ARRAY) ||
+       (index >= array->array->count)) {
+        return -1;
+    }
+
+    ljson_item_t *items = array->array->items;
+    _ljson_item_delete(json->ctx, &items[index]);
+    array->array->count--;
+    memmove(&items[index], &items[index + 1], (size_t)(array->array->count - index) * sizeof(ljson_item_t));
+
+    return 0;
+}
+
+ljson_item_t *ljson_map_set(ljson_t *json, ljson_item_t *map, const char *key, const ljson_item_t *value) {
+    if(map->type != LJSON_ITEMTYPE_MAP) {
+        return NULL;
+    }
+
+    /* Copy first, value may be part of the map */
+    ljson_item_t copy;
+    if(_ljson_item_copy(json->ctx, &copy, value)) {
+        return NULL;
+    }
+
+    int idx = _ljson_map_index(map->map, key);
+    if(idx >= 0) {
+        ljson_item_t *item = &map->map->items[idx].item;
+        _ljson_item_delete(json->ctx, item);
+        *item = copy;
+        return item;
+    }
+
+    char *name = _ljson_strdup(json->ctx, key);
+    if(!name ||
+       _ljson_map_reserve(json->ctx, map)) {
+        _ljson_free(json->ctx, name);
+        _ljson_item_delete(json->ctx, &copy);
+        return NULL;
+    }
+
+    ljson_mapitem_t *mapitem = &map->map->items[map->map->count];
+    mapitem->name = name;
+    mapitem->item = copy;
+    map->map->count++;
+
+    return &mapitem->item;
+}
+
+int ljson_map_remove(ljson_t *json, ljson_item_t *map, const char *key) {
+    if(map->type != LJSON_ITEMTYPE_MAP) {
+        return -1;
+    }
+
+    int idx = _ljson_map_index(map->map, key);
+    if(idx < 0) {
+        return -1;
+    }
+
+    ljson_mapitem_t *items = map->map->items;
+    _ljson_item_delete(json->ctx, &items[idx].item);
+    _ljson_free(json->ctx, items[idx].name);
+    map->map->count--;
+    memmove(&items[idx], &items[idx + 1], (size_t)(map->map->count - idx) * sizeof(ljson_mapitem_t));
+
+    return 0;
+}
@@ -0,0 +1,81 @@
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "lambda-json.h"
+#include "ljson_internal.h"
+
+/** The context of a zero-copy document starts at this fraction of the file
+ * size, and grows from there. Only arrays and maps are stored in it, so
+ * string-heavy input needs much less than the file size. */
+#define LJSON_FILE_CTXDIV 8
+
+void *_ljson_file_map(const char *path, int writable, uint32_t flags, size_t *len) {
+    int fd = open(path, O_RDONLY);
+    if(fd < 0) {
+        return NULL;
+    }
+
+    struct stat st;
+    if(fstat(fd, &st) || (st.st_size <= 0)) {
+        close(fd);
+        return NULL;
+    }
+    *len = (size_t)st.st_size;
+
+    /* A private writable mapping lets the parser modify the input in-situ,
+     * with only the touched pages being copied. */
+    void *map = mmap(NULL, *len, writable ? (PROT_READ | PROT_WRITE) : PROT_READ,
+                     MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(map == MAP_FAILED) {
+        return NULL;
+    }
+
+    /* Failures here only cost performance */
+    (void)madvise(map, *len, MADV_SEQUENTIAL);
+    if(flags & LJSON_PARSEFLAG_WILLNEED) {
+        (void)madvise(map, *len, MADV_WILLNEED);
+    }
+
+    return map;
+}
+
+ljson_t *ljson_parse_file(const char *path, uint32_t flags) {
+    size_t len;
+    void  *map = _ljson_file_map(path, (flags & LJSON_PARSEFLAG_ZEROCOPY) != 0, flags, &len);
+    if(!map) {
+        return NULL;
+    }
+
+    if(!(flags & LJSON_PARSEFLAG_ZEROCOPY)) {
+        ljson_t *json = _ljson_parse(NULL, (const char *)map, len, flags);
+        munmap(map, len);
+        return json;
+    }
+
+    /* Strings live in the mapping, so the document keeps it, along with
+     * everything else, in a context of its own. The context is not sized to
+     * the whole input, that would commit as much memory again as the file. */
+    size_t       size = len / LJSON_FILE_CTXDIV;
+    ljson_ctx_t *ctx  = ljson_ctx_create((size > LJSON_CTX_DEFSIZE) ? size : 0);
+    if(!ctx) {
+        munmap(map, len);
+        return NULL;
+    }
+    ctx->map     = map;
+    ctx->map_len = len;
+
+    ljson_t *json = _ljson_parse(ctx, (const char *)map, len, flags);
+    if(!json) {
+        ljson_ctx_destroy(ctx);
+        return NULL;
+    }
+    ctx->owner = json;
+
+    /* Accesses to strings from here on are not sequential */
+    (void)madvise(map, len, MADV_NORMAL);
+
+    return json;
+}
@@ -0,0 +1,95 @@
+#ifndef LJSON_INTERNAL_H
+#define LJSON_INTERNAL_H
+
+#include <stddef.h>
+
+#include "lambda-json.h"
+
+#if defined(LJSON_DEBUG)
+#  include <stdio.h>
+#  define DEBUG_PRINT(STR, ...) fprintf(stderr, "ljson debug: "STR"\n", __VA_ARGS__)
+#else
+#  define DEBUG_PRINT(STR, ...)
+#endif
+
+/** Alignment of allocations made from a context */
+#define LJSON_CTX_ALIGN   (_Alignof(max_align_t))
+/** Size of the first block of a context, if no size hint is given */
+#define LJSON_CTX_DEFSIZE 4096
+
+typedef struct ljson_ctx_block_struct ljson_ctx_block_t;
+
+/**
+ * Single contiguous block of context storage */
+struct ljson_ctx_block_struct {
+    ljson_ctx_block_t *next; /** Next (older, smaller) block */
+    size_t             size; /** Usable size of data */
+    size_t             used; /** Bytes of data handed out since last reset */
+    max_align_t        data[];
+};
+
+/**
+ * Parsing context, owning the storage of documents parsed into it */
+struct ljson_ctx_struct {
+    ljson_ctx_block_t *blocks;  /** Blocks, most recently added first */
+    ljson_t           *owner;   /** Document destroying this context along with itself, if any */
+    void              *map;     /** File mapping released along with the context, if any */
+    size_t             map_len; /** Length of map */
+};
+
+/**
+ * State shared by the parsing functions during a single parse */
+typedef struct {
+    ljson_ctx_t *ctx;   /** Context to allocate from, NULL to use the heap */
+    uint32_t     flags; /** Flags passed to the parse call, see LJSON_PARSEFLAG_* */
+    const char  *lim;   /** End of the input */
+} ljson_parser_t;
+
+/**
+ * Parse len bytes of JSON-formatted input, allocating from ctx. If
+ * LJSON_PARSEFLAG_ZEROCOPY is set, body is modified and strings point into it,
+ * this requires a context.
+ */
+ljson_t *_ljson_parse(ljson_ctx_t *ctx, const char *body, size_t len, uint32_t flags);
+
+/**
+ * Deallocates memory used within the item, but NOT the item struct itself.
+ * Does nothing for items allocated from a context.
+ */
+void _ljson_item_delete(ljson_ctx_t *ctx, ljson_item_t *item);
+
+/**
+ * Deep-copy src into dst, allocating from ctx.
+ *
+ * @return 0 on success, else -1
+ */
+int _ljson_item_copy(ljson_ctx_t *ctx, ljson_item_t *dst, const ljson_item_t *src);
+
+/**
+ * Map a file privately into memory, hinting that it will be read sequentially.
+ * If writable is set, changes to the mapping are not written to the file.
+ *
+ * @return NULL on error, else pointer to mapping of length *len
+ */
+void *_ljson_file_map(const char *path, int writable, uint32_t flags, size_t *len);
+
+/**
+ * Allocate memory from the given context, or from the heap if ctx is NULL.
+ * Context memory is aligned to LJSON_CTX_ALIGN.
+ */
+void *_ljson_alloc(ljson_ctx_t *ctx, size_t size);
+
+/**
+ * Allocate memory for characters, which need no alignment, from the given
+ * context, or from the heap if ctx is NULL. @see _ljson_alloc
+ */
+void *_ljson_alloc_str(ljson_ctx_t *ctx, size_t size);
+
+/**
+ * Release memory obtained from _ljson_alloc or _ljson_alloc_str. Memory belonging to a context is
+ * only reclaimed when the context is reset, so this does nothing if ctx is
+ * not NULL.
+ */
+void _ljson_free(ljson_ctx_t *ctx, void *ptr);
+
+#endif
@@ -1,36 +1,49 @@
-#include <strings.h>
 #include <string.h>
 #include <stdlib.h>
 #include <ctype.h>
+#include <errno.h>
 
 #include "lambda-json.h"
+#include "ljson_internal.h"
 
-#if defined(LJSON_DEBUG)
-#  include <stdio.h>
-#  define DEBUG_PRINT(STR, ...) fprintf(stderr, "ljson debug: "STR"\n", __VA_ARGS__)
-#else
-#  define DEBUG_PRINT(STR, ...)
+/** Whether single-quoted strings are compiled in, for use in conditions */
+#define LJSON_HAS_SQUOTE ((LJSON_FEATURES & LJSON_FEATURE_SQUOTE) != 0)
+
+static int         _ljson_item_parse(ljson_parser_t *, const char *, const char **, ljson_item_t *);
+static const char *_skipwht(const ljson_parser_t *, const char *);
+
+ljson_t *_ljson_parse(ljson_ctx_t *ctx, const char *body, size_t len, uint32_t flags) {
+#if !(LJSON_FEATURES & LJSON_FEATURE_RAWNUMBER)
+    if(flags & LJSON_PARSEFLAG_RAWNUMBERS) {
+        /* Not compiled in */
+        return NULL;
+    }
 #endif
 
-static int         _ljson_item_parse(const char *, const char **, ljson_item_t *);
-static void        _ljson_item_delete(ljson_item_t *);
-static const char *_skipwht(const char *);
+    ljson_t *json = (ljson_t *)_ljson_alloc(ctx, sizeof(ljson_t));
+    if(!json) {
+        return NULL;
+    }
+    json->ctx = ctx;
 
-ljson_t *ljson_parse(const char *body, uint32_t flags) {
-    ljson_t *json = (ljson_t *)malloc(sizeof(ljson_t));
+    ljson_parser_t parser = {
+        .ctx   = ctx,
+        .flags = flags,
+        .lim   = body + len
+    };
 
     const char *end = body;
 
-    if(_ljson_item_parse(body, &end, &json->root)) {
+    if(_ljson_item_parse(&parser, body, &end, &json->root)) {
         DEBUG_PRINT("Parsing failed around position %lu", (end - body));
-        free(json);
+        _ljson_free(ctx, json);
         return NULL;
     }
 
     if(!(flags & LJSON_PARSEFLAG_LENIENT)) {
         /* Check that we are at the end of the input */
-        end = _skipwht(end);
-        if(*end != '\0') {
+        end = _skipwht(&parser, end);
+        if(end != parser.lim) {
             ljson_destroy(json);
             return NULL;
         }
@@ -39,30 +52,54 @@ ljson_t *ljson_parse(const char *body, uint32_t flags) {
     return json;
 }
 
+ljson_t *ljson_parse(const char *body, uint32_t flags) {
+    return ljson_parse_len(body, strlen(body), flags);
+}
+
+ljson_t *ljson_parse_len(const char *body, size_t len, uint32_t flags) {
+    /* Input is const, so it may not be parsed in-situ */
+    return _ljson_parse(NULL, body, len, flags & ~LJSON_PARSEFLAG_ZEROCOPY);
+}
+
+ljson_t *ljson_parse_into(ljson_ctx_t *ctx, const char *body, uint32_t flags) {
+    ljson_ctx_reset(ctx);
+    return _ljson_parse(ctx, body, strlen(body), flags & ~LJSON_PARSEFLAG_ZEROCOPY);
+}
+
 void ljson_destroy(ljson_t *json) {
-    _ljson_item_delete(&json->root);
+    if(json->ctx) {
+        if(json->ctx->owner == json) {
+            /* Private context, e.g. from ljson_parse_file */
+            ljson_ctx_destroy(json->ctx);
+        }
+        /* Otherwise storage is owned by the context */
+        return;
+    }
+    _ljson_item_delete(NULL, &json->root);
     free(json);
 }
 
-/**
- * Deallocates memory used within the item, but NOT the item struct itself.
- */
-static void _ljson_item_delete(ljson_item_t *item) {
+void _ljson_item_delete(ljson_ctx_t *ctx, ljson_item_t *item) {
+    if(ctx) {
+        return;
+    }
+
     switch(item->type) {
         case LJSON_ITEMTYPE_STRING:
+        case LJSON_ITEMTYPE_RAWNUMBER:
             free(item->str);
             break;
 
         case LJSON_ITEMTYPE_ARRAY:
             for(uint16_t i = 0; i < item->array->count; i++) {
-                _ljson_item_delete(&item->array->items[i]);
+                _ljson_item_delete(ctx, &item->array->items[i]);
             }
             free(item->array);
             break;
 
         case LJSON_ITEMTYPE_MAP:
             for(uint16_t i = 0; i < item->map->count; i++) {
-                _ljson_item_delete(&item->map->items[i].item);
+                _ljson_item_delete(ctx, &item->map->items[i].item);
                 free(item->map->items[i].name);
             }
             free(item->map);
@@ -70,6 +107,7 @@ static void _ljson_item_delete(ljson_item_t *item) {
 
         case LJSON_ITEMTYPE_NONE:
         case LJSON_ITEMTYPE_NULL:
+        case LJSON_ITEMTYPE_BOOLEAN:
         case LJSON_ITEMTYPE_INTEGER:
         case LJSON_ITEMTYPE_FLOAT:
             /* Nothing is allocated for these types */
@@ -91,6 +129,63 @@ ljson_item_t *ljson_map_search(ljson_map_t *map, const char *key) {
     return NULL;
 }
 
+int ljson_number_int(const ljson_item_t *item, LJSON_INTTYPE *value) {
+    if(item->type == LJSON_ITEMTYPE_INTEGER) {
+        *value = item->integer;
+        return 0;
+    }
+    if(item->type != LJSON_ITEMTYPE_RAWNUMBER) {
+        return -1;
+    }
+
+    char *end;
+    errno = 0;
+    long long val = strtoll(item->str, &end, 10);
+    if(*end || (errno == ERANGE) ||
+       ((LJSON_INTTYPE)val != val)) {
+        /* Not an integer, or does not fit */
+        return -1;
+    }
+
+    *value = (LJSON_INTTYPE)val;
+    return 0;
+}
+
+int ljson_number_float(const ljson_item_t *item, LJSON_FLOATTYPE *value) {
+    switch(item->type) {
+        case LJSON_ITEMTYPE_INTEGER:
+            *value = (LJSON_FLOATTYPE)item->integer;
+            return 0;
+
+        case LJSON_ITEMTYPE_FLOAT:
+            *value = item->flt;
+            return 0;
+
+        case LJSON_ITEMTYPE_RAWNUMBER: {
+            char *end;
+            *value = (LJSON_FLOATTYPE)strtod(item->str, &end);
+            return *end ? -1 : 0;
+        }
+
+        case LJSON_ITEMTYPE_NONE:
+        case LJSON_ITEMTYPE_NULL:
+        case LJSON_ITEMTYPE_BOOLEAN:
+        case LJSON_ITEMTYPE_STRING:
+        case LJSON_ITEMTYPE_ARRAY:
+        case LJSON_ITEMTYPE_MAP:
+            break;
+    }
+
+    return -1;
+}
+
+/**
+ * Returns the character at the given position, or '\0' if it is past the end
+ * of the input.
+ */
+static inline char _peek(const ljson_parser_t *parser, const char *text) {
+    return (text < parser->lim) ? *text : '\0';
+}
 
 /**
  * Checks if character is whitespace
@@ -106,54 +201,172 @@ static int _iswht(char ch) {
  * Skips whitespace characters in string, and returns pointer to first
  * non-whitespace character.
  */
-static const char *_skipwht(const char *text) {
-    while(_iswht(*text)) text++;
+static const char *_skipwht(const ljson_parser_t *parser, const char *text) {
+    while((text < parser->lim) && _iswht(*text)) text++;
     return text;
 }
 
-static int _ljson_item_parse_number(const char *body, const char **end, ljson_item_t *item) {
-    unsigned i = 0;
-    if(body[i] == '-' || body[i] == '+') i++;
-    while(isdigit(body[i])) i++;
+/**
+ * Checks if character may be part of a number. strto* are only given spans
+ * of these characters, as the input is not necessarily NUL-terminated.
+ */
+static int _isnumch(char ch) {
+    return (isdigit((unsigned char)ch) ||
+            (ch == '-') || (ch == '+') ||
+            (ch == '.') ||
+            (ch == 'e') || (ch == 'E'));
+}
+
+/**
+ * Returns the length of the longest prefix of str that is a number as per the
+ * JSON grammar, 0 if there is none. Unlike strto*, this rejects leading zeros,
+ * and a '.' without digits on both sides.
+ */
+static size_t _ljson_number_strict_len(const char *str) {
+    size_t i = 0;
+    if(str[i] == '-') i++;
+
+    if(str[i] == '0') {
+        i++;
+    } else if(isdigit((unsigned char)str[i])) {
+        while(isdigit((unsigned char)str[i])) i++;
+    } else {
+        return 0;
+    }
+
+    if((str[i] == '.') && isdigit((unsigned char)str[i + 1])) {
+        i++;
+        while(isdigit((unsigned char)str[i])) i++;
+    }
+
+    if((str[i] == 'e') || (str[i] == 'E')) {
+        size_t exp = i + 1;
+        if((str[exp] == '-') || (str[exp] == '+')) exp++;
+        if(isdigit((unsigned char)str[exp])) {
+            while(isdigit((unsigned char)str[exp])) exp++;
+            i = exp;
+        }
+    }
+
+    return i;
+}
+
+/**
+ * Checks that the span of buf converted by strto*, ending at end, is a number
+ * as per the JSON grammar if LJSON_PARSEFLAG_STRICT is set. strto* accept
+ * more than JSON does, e.g. 01 or 1., and consume nothing for a bare -.
+ */
+static int _ljson_number_strict_ok(const ljson_parser_t *parser, const char *buf, const char *end) {
+    if(!(parser->flags & LJSON_PARSEFLAG_STRICT)) {
+        return 1;
+    }
+    size_t len = _ljson_number_strict_len(buf);
+    return len && (len == (size_t)(end - buf));
+}
+
+/** Numbers longer than this are copied to the heap for conversion */
+#define LJSON_NUMBUF_SIZE 64
+
+static int _ljson_item_parse_number(ljson_parser_t *parser, const char *body, const char **end, ljson_item_t *item) {
+    size_t i = 0;
+    if(_peek(parser, &body[i]) == '-' || _peek(parser, &body[i]) == '+') i++;
+    while(isdigit((unsigned char)_peek(parser, &body[i]))) i++;
+    /* A fraction or an exponent both make a floating-point number */
+    char next  = _peek(parser, &body[i]);
+    int  isflt = ((next == '.') || (next == 'e') || (next == 'E'));
+
+    size_t len = i;
+    while(_isnumch(_peek(parser, &body[len]))) len++;
+
+    /* Copy to a NUL-terminated buffer for strto* */
+    char  sbuf[LJSON_NUMBUF_SIZE];
+    char *buf = sbuf;
+    if(len >= sizeof(sbuf)) {
+        buf = (char *)malloc(len + 1);
+        if(!buf) {
+            return -1;
+        }
+    }
+    memcpy(buf, body, len);
+    buf[len] = '\0';
+
     /* To comply with strto* signature */
     char *_end;
-
-    if(body[i] == '.') {
+    int   ret = 0;
+
+#if (LJSON_FEATURES & LJSON_FEATURE_RAWNUMBER)
+    if(parser->flags & LJSON_PARSEFLAG_RAWNUMBERS) {
+        /* Only check that the span is a number, conversion is up to the user */
+        (void)strtod(buf, &_end);
+        size_t nlen = (size_t)(_end - buf);
+        item->type = LJSON_ITEMTYPE_RAWNUMBER;
+        item->str  = (nlen && _ljson_number_strict_ok(parser, buf, _end)) ?
+                     (char *)_ljson_alloc_str(parser->ctx, nlen + 1) : NULL;
+        if(item->str) {
+            memcpy(item->str, buf, nlen);
+            item->str[nlen] = '\0';
+            DEBUG_PRINT("raw number: %s", item->str);
+        } else {
+            ret = -1;
+        }
+    } else
+#endif
+    if(isflt) {
+#if (LJSON_FEATURES & LJSON_FEATURE_FLOAT)
         item->type = LJSON_ITEMTYPE_FLOAT;
-        item->flt  = (LJSON_FLOATTYPE)strtod(body, &_end);
-        DEBUG_PRINT("float: %lf", item->flt);
+        item->flt  = (LJSON_FLOATTYPE)strtod(buf, &_end);
+        DEBUG_PRINT("float: %lf", (double)item->flt);
+#else
+        _end = buf;
+        ret  = -1;
+#endif
     } else {
+        errno = 0;
+        long long val = strtoll(buf, &_end, 10);
         item->type    = LJSON_ITEMTYPE_INTEGER;
-        item->integer = (LJSON_INTTYPE)strtol(body, &_end, 10);
-        DEBUG_PRINT("integer: %d", item->integer);
+        item->integer = (LJSON_INTTYPE)val;
+        if((errno == ERANGE) ||
+           (item->integer != val)) {
+            /* Does not fit in LJSON_INTTYPE */
+            ret = -1;
+        }
+        DEBUG_PRINT("integer: %lld", val);
     }
 
-    *end = _end;
+    if(!_ljson_number_strict_ok(parser, buf, _end)) {
+        ret = -1;
+    }
 
-    return 0;
+    *end = body + (_end - buf);
+
+    if(buf != sbuf) {
+        free(buf);
+    }
+
+    return ret;
 }
 
-static int _count_items(const char *body) {
+static int _count_items(const ljson_parser_t *parser, const char *body) {
     /* @note This could be simplified by simply making arrays and maps dynamic
      * lists. Major concern is performance impact, both in speed an memory
      * utilization - this needs to be examined first */
-    const char *next = _skipwht(body+1);
-    if((*body == '{' && *next == '}') ||
-       (*body == '[' && *next == ']')) {
+    const char *next = _skipwht(parser, body+1);
+    if((*body == '{' && _peek(parser, next) == '}') ||
+       (*body == '[' && _peek(parser, next) == ']')) {
         /* No items */
         return 0;
     }
-    
+
     uint16_t count = 1;
     uint16_t depth = 1;
     char     instr = '\0';
     int      esc   = 0;
     body++;
 
-    while(depth && *body) {
+    while(depth && (body < parser->lim) && *body) {
         if(!instr) {
             if((*body == '"') ||
-               (*body == '\'')) {
+               (LJSON_HAS_SQUOTE && (*body == '\''))) {
                 /* Start of string */
                 instr = *body;
             } else if((*body == '[') ||
@@ -192,49 +405,50 @@ static int _count_items(const char *body) {
     return count;
 }
 
-static int _ljson_item_parse_array(const char *body, const char **end, ljson_item_t *item) {
+static int _ljson_item_parse_array(ljson_parser_t *parser, const char *body, const char **end, ljson_item_t *item) {
     item->type = LJSON_ITEMTYPE_ARRAY;
 
     int fail = 0;
-    int count = _count_items(body);
+    int count = _count_items(parser, body);
     if(count < 0) {
         return -1;
     }
     DEBUG_PRINT("array item count: %d", count);
     body++;
 
-    item->array = (ljson_array_t *)malloc(sizeof(ljson_array_t) + ((size_t)count * sizeof(ljson_item_t)));
+    item->array = (ljson_array_t *)_ljson_alloc(parser->ctx, sizeof(ljson_array_t) + ((size_t)count * sizeof(ljson_item_t)));
     if(!item->array) {
         return -1;
     }
-    item->array->count = 0;
+    item->array->count    = 0;
+    item->array->capacity = (uint16_t)count;
 
     int i = 0;
     for(; i < count; i++) {
-        if(_ljson_item_parse(body, end, &item->array->items[i])) {
+        if(_ljson_item_parse(parser, body, end, &item->array->items[i])) {
             fail = 1;
             break;
         } else {
             /* We increment this one at a time, so delete can still work */
             item->array->count = (uint16_t)(i + 1);
             body = *end;
-            body = _skipwht(body);
-            if(*body != ',') {
+            body = _skipwht(parser, body);
+            if(_peek(parser, body) != ',') {
                 /* End of array, or bad formatting */
                 break;
             }
             body++;
         }
     }
-    
-    body = _skipwht(body);
+
+    body = _skipwht(parser, body);
 
     if((count == 0 && i != 0)         ||
        (count      && i != (count-1)) ||
-       (*body != ']')                 ||
+       (_peek(parser, body) != ']')   ||
        fail) {
-        DEBUG_PRINT("array fail: (%d, %d), %c, %d", i, count, *body, fail);
-        _ljson_item_delete(item);
+        DEBUG_PRINT("array fail: (%d, %d), %c, %d", i, count, _peek(parser, body), fail);
+        _ljson_item_delete(parser->ctx, item);
         return -1;
     }
 
@@ -243,84 +457,94 @@ static int _ljson_item_parse_array(const char *body, const char **end, ljson_ite
     return 0;
 }
 
-static int _ljson_parse_mapitem(const char *body, const char **end, ljson_mapitem_t *mapitem) {
-    body = _skipwht(body);
-    char strch = *body;
+static int _ljson_parse_mapitem(ljson_parser_t *parser, const char *body, const char **end, ljson_mapitem_t *mapitem) {
+    body = _skipwht(parser, body);
+    char strch = _peek(parser, body);
     if((strch != '"') &&
-       (strch != '\'')) {
+       (!LJSON_HAS_SQUOTE                         ||
+        (parser->flags & LJSON_PARSEFLAG_STRICT) ||
+        (strch != '\''))) {
         return -1;
     }
     body++;
     size_t len = 0;
-    while(body[len] != strch) {
-        if(body[len] == '\0') {
+    while(_peek(parser, &body[len]) != strch) {
+        if(_peek(parser, &body[len]) == '\0') {
             return -1;
         }
         len++;
     }
-    mapitem->name = strndup(body, len);
-    if(!mapitem->name) {
-        return -1;
+    if(parser->flags & LJSON_PARSEFLAG_ZEROCOPY) {
+        /* Terminate the key in place of its closing quote */
+        mapitem->name = (char *)body;
+    } else {
+        mapitem->name = (char *)_ljson_alloc_str(parser->ctx, len + 1);
+        if(!mapitem->name) {
+            return -1;
+        }
+        memcpy(mapitem->name, body, len);
     }
+    mapitem->name[len] = '\0';
 
-    body = _skipwht(&body[len + 1]);
-    if(*body != ':') {
-        free(mapitem->name);
+    body = _skipwht(parser, &body[len + 1]);
+    if(_peek(parser, body) != ':') {
+        _ljson_free(parser->ctx, mapitem->name);
         return -1;
     }
     body++;
 
-    if(_ljson_item_parse(body, end, &mapitem->item)) {
-        free(mapitem->name);
+    if(_ljson_item_parse(parser, body, end, &mapitem->item)) {
+        _ljson_free(parser->ctx, mapitem->name);
         return -1;
     }
 
     return 0;
 }
 
-static int _ljson_item_parse_map(const char *body, const char **end, ljson_item_t *item) {
+static int _ljson_item_parse_map(ljson_parser_t *parser, const char *body, const char **end, ljson_item_t *item) {
     item->type = LJSON_ITEMTYPE_MAP;
 
     int fail = 0;
-    int count = _count_items(body);
+    int count = _count_items(parser, body);
     if(count < 0) {
         return -1;
     }
     DEBUG_PRINT("map item count: %d", count);
     body++;
 
-    item->map = (ljson_map_t *)malloc(sizeof(ljson_map_t) + ((size_t)count * sizeof(ljson_mapitem_t)));
+    item->map = (ljson_map_t *)_ljson_alloc(parser->ctx, sizeof(ljson_map_t) + ((size_t)count * sizeof(ljson_mapitem_t)));
     if(!item->map) {
         return -1;
     }
-    item->map->count = 0;
-    
+    item->map->count    = 0;
+    item->map->capacity = (uint16_t)count;
+
     int i = 0;
     for(; i < count; i++) {
-        if(_ljson_parse_mapitem(body, end, &item->map->items[i])) {
+        if(_ljson_parse_mapitem(parser, body, end, &item->map->items[i])) {
             fail = 1;
             break;
         } else {
             /* We increment this one at a time, so delete can still work */
             item->map->count = (uint16_t)(i + 1);
             body = *end;
-            body = _skipwht(body);
-            if(*body != ',') {
+            body = _skipwht(parser, body);
+            if(_peek(parser, body) != ',') {
                 /* End of map, or bad formatting */
                 break;
             }
             body++;
         }
     }
-    
-    body = _skipwht(body);
+
+    body = _skipwht(parser, body);
 
     if((count == 0 && i != 0)         ||
        (count      && i != (count-1)) ||
-       (*body != '}')                 ||
+       (_peek(parser, body) != '}')   ||
        fail) {
-        DEBUG_PRINT("map fail: (%d, %d), %c, %d", i, count, *body, fail);
-        _ljson_item_delete(item);
+        DEBUG_PRINT("map fail: (%d, %d), %c, %d", i, count, _peek(parser, body), fail);
+        _ljson_item_delete(parser->ctx, item);
         return -1;
     }
 
@@ -329,14 +553,14 @@ static int _ljson_item_parse_map(const char *body, const char **end, ljson_item_
     return 0;
 }
 
-static int _ljson_item_parse_string(const char *body, const char **end, ljson_item_t *item) {
+static int _ljson_item_parse_string(ljson_parser_t *parser, const char *body, const char **end, ljson_item_t *item) {
     item->type  = LJSON_ITEMTYPE_STRING;
     char endchr = *body;
     body++;
 
     size_t sz = 0, esc = 0;
-    while(body[sz] != endchr) {
-        if(body[sz] == '\0') {
+    while(_peek(parser, &body[sz]) != endchr) {
+        if(_peek(parser, &body[sz]) == '\0') {
             /* Did not find the end of string */
             return -1;
         }
@@ -349,21 +573,33 @@ static int _ljson_item_parse_string(const char *body, const char **end, ljson_it
         sz++;
     }
 
-    item->str = (char *)malloc((sz - esc) + 1);
-    if(!item->str) {
-        return -1;
+    if(parser->flags & LJSON_PARSEFLAG_ZEROCOPY) {
+        /* Unescaping only ever shrinks the string, so it can be done in
+         * place, terminating it at or before its closing quote */
+        item->str = (char *)body;
+    } else {
+        item->str = (char *)_ljson_alloc_str(parser->ctx, (sz - esc) + 1);
+        if(!item->str) {
+            return -1;
+        }
     }
 
-    size_t idx = 0;
+    /* Previous input character is tracked separately, as the input may
+     * already have been overwritten when unescaping in place */
+    size_t idx  = 0;
+    char   prev = '\0';
     for(size_t i = 0; i < sz; i++) {
-        if(body[i] == '\\') {
+        char ch = body[i];
+        if(ch == '\\') {
             /* For now, we just accept whatever comes after the \ as it is
              * written. We do not currently handle special situations such as \n */
-            if((i == 0) || (body[i-1] != '\\')) {
+            if(prev != '\\') {
+                prev = ch;
                 continue;
             }
         }
-        item->str[idx++] = body[i];
+        prev = ch;
+        item->str[idx++] = ch;
     }
     item->str[idx] = '\0';
 
@@ -372,29 +608,126 @@ static int _ljson_item_parse_string(const char *body, const char **end, ljson_it
 }
 
 
-static int _ljson_item_parse(const char *body, const char **end, ljson_item_t *item) {
-    body = _skipwht(body);
+/**
+ * Value types, as told apart by their first character */
+typedef enum {
+    LJSON_DISPATCH_NONE = 0, /** Not the start of a value */
+    LJSON_DISPATCH_NUMBER,   /** Digit or - */
+    LJSON_DISPATCH_PLUS,     /** +, not allowed in strict mode */
+    LJSON_DISPATCH_ARRAY,    /** [ */
+    LJSON_DISPATCH_MAP,      /** { */
+    LJSON_DISPATCH_STRING,   /** " */
+    LJSON_DISPATCH_SQSTRING, /** ', not allowed in strict mode */
+    LJSON_DISPATCH_NULL,     /** n, or N outside of strict mode */
+    LJSON_DISPATCH_TRUE,     /** t, or T outside of strict mode */
+    LJSON_DISPATCH_FALSE     /** f, or F outside of strict mode */
+} ljson_dispatch_e;
+
+static const uint8_t _dispatch[256] = {
+    ['0']  = LJSON_DISPATCH_NUMBER, ['1'] = LJSON_DISPATCH_NUMBER,
+    ['2']  = LJSON_DISPATCH_NUMBER, ['3'] = LJSON_DISPATCH_NUMBER,
+    ['4']  = LJSON_DISPATCH_NUMBER, ['5'] = LJSON_DISPATCH_NUMBER,
+    ['6']  = LJSON_DISPATCH_NUMBER, ['7'] = LJSON_DISPATCH_NUMBER,
+    ['8']  = LJSON_DISPATCH_NUMBER, ['9'] = LJSON_DISPATCH_NUMBER,
+    ['-']  = LJSON_DISPATCH_NUMBER, ['+'] = LJSON_DISPATCH_PLUS,
+    ['[']  = LJSON_DISPATCH_ARRAY,
+    ['{']  = LJSON_DISPATCH_MAP,
+    ['"']  = LJSON_DISPATCH_STRING,
+#if (LJSON_FEATURES & LJSON_FEATURE_SQUOTE)
+    ['\''] = LJSON_DISPATCH_SQSTRING,
+#endif
+    ['n']  = LJSON_DISPATCH_NULL,   ['N'] = LJSON_DISPATCH_NULL,
+    ['t']  = LJSON_DISPATCH_TRUE,   ['T'] = LJSON_DISPATCH_TRUE,
+    ['f']  = LJSON_DISPATCH_FALSE,  ['F'] = LJSON_DISPATCH_FALSE
+};
+
+/**
+ * Checks if the input starts with the given lower-case literal, of 4 or 5
+ * characters. The first 4 are compared as a single word. Outside of strict
+ * mode case is ignored, by setting the ASCII lower-case bit on the input.
+ */
+static int _ljson_literal(const ljson_parser_t *parser, const char *body, const char *lit, size_t len) {
+    if((size_t)(parser->lim - body) < len) {
+        return 0;
+    }
+
+    uint32_t in, ref;
+    memcpy(&in,  body, sizeof(in));
+    memcpy(&ref, lit,  sizeof(ref));
+
+    uint32_t fold = (parser->flags & LJSON_PARSEFLAG_STRICT) ? 0 : 0x20202020UL;
+    if((in | fold) != ref) {
+        return 0;
+    }
+
+    return (len == 4) ||
+           ((char)(body[4] | (char)fold) == lit[4]);
+}
+
+static int _ljson_item_parse(ljson_parser_t *parser, const char *body, const char **end, ljson_item_t *item) {
+    body = _skipwht(parser, body);
 
     DEBUG_PRINT("_ljson_item_parse: %p, %p, %p", body, end, item);
 
     int ret = -1;
 
-    if(isdigit(*body) || *body == '-' || *body == '+') {
-        ret = _ljson_item_parse_number(body, end, item);
-    } else if(*body == '[') {
-        ret = _ljson_item_parse_array(body, end, item);
-    } else if(*body == '{') {
-        ret = _ljson_item_parse_map(body, end, item);
-    } else if((*body == '"') ||
-              (*body == '\'')) {
-        ret = _ljson_item_parse_string(body, end, item);
-    } else if(!strncasecmp(body, "null", 4)) {
-        /* Perhaps a little too lenient on case? */
-        item->type = LJSON_ITEMTYPE_NULL;
-        *end       = body + 4;
-        ret = 0;
-    }
-    
+    switch((ljson_dispatch_e)_dispatch[(unsigned char)_peek(parser, body)]) {
+        case LJSON_DISPATCH_PLUS:
+            if(parser->flags & LJSON_PARSEFLAG_STRICT) {
+                break;
+            }
+            /* fall through */
+        case LJSON_DISPATCH_NUMBER:
+            ret = _ljson_item_parse_number(parser, body, end, item);
+            break;
+
+        case LJSON_DISPATCH_ARRAY:
+            ret = _ljson_item_parse_array(parser, body, end, item);
+            break;
+
+        case LJSON_DISPATCH_MAP:
+            ret = _ljson_item_parse_map(parser, body, end, item);
+            break;
+
+        case LJSON_DISPATCH_SQSTRING:
+            if(parser->flags & LJSON_PARSEFLAG_STRICT) {
+                break;
+            }
+            /* fall through */
+        case LJSON_DISPATCH_STRING:
+            ret = _ljson_item_parse_string(parser, body, end, item);
+            break;
+
+        case LJSON_DISPATCH_NULL:
+            if(_ljson_literal(parser, body, "null", 4)) {
+                item->type = LJSON_ITEMTYPE_NULL;
+                *end       = body + 4;
+                ret = 0;
+            }
+            break;
+
+        case LJSON_DISPATCH_TRUE:
+            if(_ljson_literal(parser, body, "true", 4)) {
+                item->type    = LJSON_ITEMTYPE_BOOLEAN;
+                item->boolean = 1;
+                *end          = body + 4;
+                ret = 0;
+            }
+            break;
+
+        case LJSON_DISPATCH_FALSE:
+            if(_ljson_literal(parser, body, "false", 5)) {
+                item->type    = LJSON_ITEMTYPE_BOOLEAN;
+                item->boolean = 0;
+                *end          = body + 5;
+                ret = 0;
+            }
+            break;
+
+        case LJSON_DISPATCH_NONE:
+            break;
+    }
+
     if(!ret) {
         DEBUG_PRINT("parsed: %.*s", (int)(*end - body), body);
     }
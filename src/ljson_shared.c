@@ -0,0 +1,140 @@
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <sched.h>
+
+#include "lambda-json.h"
+
+/**
+ * Reference-counted handle to an immutable document */
+struct ljson_shared_struct {
+    ljson_t      *json; /** Document, destroyed along with the handle */
+    atomic_size_t refs; /** Number of references held */
+};
+
+/**
+ * Slot publishing the current version of a shared document.
+ *
+ * Readers register in the reader count of the current epoch before loading
+ * the document, and leave it once they hold a reference. A publisher swaps
+ * in the new document, moves on to the next epoch, then waits for readers of
+ * the previous epoch to leave before dropping its reference to the old
+ * document. Readers that saw the old document thus always get their
+ * reference before it can be destroyed.
+ */
+struct ljson_slot_struct {
+    ljson_shared_t *_Atomic current;    /** Published document */
+    atomic_uint             epoch;      /** Current epoch, readers register in readers[epoch & 1] */
+    atomic_size_t           readers[2]; /** Readers between registering and taking a reference */
+    atomic_flag             publish;    /** Held while publishing, publishers are serialized */
+};
+
+ljson_shared_t *ljson_shared_create(ljson_t *json) {
+    if(!json) {
+        return NULL;
+    }
+
+    ljson_shared_t *shared = (ljson_shared_t *)malloc(sizeof(ljson_shared_t));
+    if(!shared) {
+        return NULL;
+    }
+
+    shared->json = json;
+    atomic_init(&shared->refs, 1);
+
+    return shared;
+}
+
+ljson_shared_t *ljson_shared_ref(ljson_shared_t *shared) {
+    /* The caller already holds a reference, so nothing needs ordering here */
+    atomic_fetch_add_explicit(&shared->refs, 1, memory_order_relaxed);
+    return shared;
+}
+
+void ljson_shared_unref(ljson_shared_t *shared) {
+    if(!shared) {
+        return;
+    }
+
+    /* Release our accesses to the document, acquire everyone else's before
+     * destroying it */
+    if(atomic_fetch_sub_explicit(&shared->refs, 1, memory_order_acq_rel) == 1) {
+        ljson_destroy(shared->json);
+        free(shared);
+    }
+}
+
+ljson_t *ljson_shared_doc(const ljson_shared_t *shared) {
+    return shared->json;
+}
+
+ljson_slot_t *ljson_slot_create(ljson_shared_t *shared) {
+    ljson_slot_t *slot = (ljson_slot_t *)malloc(sizeof(ljson_slot_t));
+    if(!slot) {
+        return NULL;
+    }
+
+    atomic_init(&slot->current, shared ? ljson_shared_ref(shared) : NULL);
+    atomic_init(&slot->epoch, 0);
+    atomic_init(&slot->readers[0], 0);
+    atomic_init(&slot->readers[1], 0);
+    atomic_flag_clear_explicit(&slot->publish, memory_order_relaxed);
+
+    return slot;
+}
+
+void ljson_slot_destroy(ljson_slot_t *slot) {
+    if(!slot) {
+        return;
+    }
+
+    ljson_shared_unref(atomic_load_explicit(&slot->current, memory_order_acquire));
+    free(slot);
+}
+
+ljson_shared_t *ljson_slot_acquire(ljson_slot_t *slot) {
+    unsigned epoch;
+
+    /* Sequentially consistent, so either we see the publisher move to the
+     * next epoch, or the publisher sees us registered in this one */
+    for(;;) {
+        epoch = atomic_load_explicit(&slot->epoch, memory_order_seq_cst);
+        atomic_fetch_add_explicit(&slot->readers[epoch & 1], 1, memory_order_seq_cst);
+        if(atomic_load_explicit(&slot->epoch, memory_order_seq_cst) == epoch) {
+            break;
+        }
+        atomic_fetch_sub_explicit(&slot->readers[epoch & 1], 1, memory_order_seq_cst);
+    }
+
+    ljson_shared_t *shared = atomic_load_explicit(&slot->current, memory_order_seq_cst);
+    if(shared) {
+        ljson_shared_ref(shared);
+    }
+
+    atomic_fetch_sub_explicit(&slot->readers[epoch & 1], 1, memory_order_release);
+
+    return shared;
+}
+
+void ljson_slot_publish(ljson_slot_t *slot, ljson_shared_t *shared) {
+    if(shared) {
+        ljson_shared_ref(shared);
+    }
+
+    while(atomic_flag_test_and_set_explicit(&slot->publish, memory_order_acquire)) {
+        sched_yield();
+    }
+
+    ljson_shared_t *old   = atomic_exchange_explicit(&slot->current, shared, memory_order_seq_cst);
+    unsigned        epoch = atomic_fetch_add_explicit(&slot->epoch, 1, memory_order_seq_cst);
+
+    /* Readers registered in the previous epoch may still be taking a
+     * reference to old. Readers are only registered for a few instructions,
+     * so this does not wait long. */
+    while(atomic_load_explicit(&slot->readers[epoch & 1], memory_order_seq_cst)) {
+        sched_yield();
+    }
+
+    atomic_flag_clear_explicit(&slot->publish, memory_order_release);
+
+    ljson_shared_unref(old);
+}
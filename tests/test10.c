@@ -0,0 +1,141 @@
+#include <string.h>
+#include <stdio.h>
+
+#include "lambda-json.h"
+
+/* Test 10:
+ *   Tests structural diffs, and merge patches (RFC 7386). */
+
+static const struct {
+    const char *a;
+    const char *b;
+    const char *ops; /** Expected operations, as "op path" joined by ',' */
+} _diffs[] = {
+    { "{'a':1,'b':[1,2]}", "{'b':[1,2],'a':1}",   "" },
+    { "1",                 "2",                   "replace " },
+    { "1",                 "1.0",                 "replace " },
+    { "'abc'",             "'abc'",               "" },
+    { "0.0",               "-0.0",                "replace " },
+    { "{'a':1}",           "{'a':2}",             "replace /a" },
+    { "{'a':1}",           "{'b':1}",             "remove /a,add /b" },
+    { "{'a/b':1,'c~':2}",  "{'a/b':2,'c~':3}",    "replace /a~1b,replace /c~0" },
+    { "[1,2,3]",           "[1,5,3,4]",           "replace /1,add /3" },
+    { "[1,2,3,4]",         "[1]",                 "remove /3,remove /2,remove /1" },
+    { "{'a':{'b':[{'c':true}]}}",
+      "{'a':{'b':[{'c':false}]}}",                "replace /a/b/0/c" },
+    { "{'a':[1],'b':{'c':null}}",
+      "{'a':{},'b':{'c':null}}",                  "replace /a" },
+};
+#define N_DIFFS (sizeof(_diffs) / sizeof(_diffs[0]))
+
+static const struct {
+    const char *base;
+    const char *patch;
+    const char *result;
+} _merges[] = {
+    /* From RFC 7386, Appendix A */
+    { "{'a':'b'}",             "{'a':'c'}",                   "{'a':'c'}" },
+    { "{'a':'b'}",             "{'b':'c'}",                   "{'a':'b','b':'c'}" },
+    { "{'a':'b'}",             "{'a':null}",                  "{}" },
+    { "{'a':'b','b':'c'}",     "{'a':null}",                  "{'b':'c'}" },
+    { "{'a':['b']}",           "{'a':'c'}",                   "{'a':'c'}" },
+    { "{'a':'c'}",             "{'a':['b']}",                 "{'a':['b']}" },
+    { "{'a':{'b':'c'}}",       "{'a':{'b':'d','c':null}}",    "{'a':{'b':'d'}}" },
+    { "{'a':[{'b':'c'}]}",     "{'a':[1]}",                   "{'a':[1]}" },
+    { "['a','b']",             "['c','d']",                   "['c','d']" },
+    { "{'a':'b'}",             "['c']",                       "['c']" },
+    { "{'a':'foo'}",           "null",                        "null" },
+    { "{'a':'foo'}",           "'bar'",                       "'bar'" },
+    { "{'e':null}",            "{'a':1}",                     "{'e':null,'a':1}" },
+    { "[1,2]",                 "{'a':'b','c':null}",          "{'a':'b'}" },
+    { "{}",                    "{'a':{'bb':{'ccc':null}}}",   "{'a':{'bb':{}}}" },
+};
+#define N_MERGES (sizeof(_merges) / sizeof(_merges[0]))
+
+/**
+ * Summarize patch as "op path" joined by ',' */
+static int _ops(const ljson_t *patch, char *buf, size_t len) {
+    buf[0] = '\0';
+    for(uint16_t i = 0; i < patch->root.array->count; i++) {
+        ljson_map_t  *entry = patch->root.array->items[i].map;
+        ljson_item_t *op    = ljson_map_search_type(entry, "op",   LJSON_ITEMTYPE_STRING);
+        ljson_item_t *path  = ljson_map_search_type(entry, "path", LJSON_ITEMTYPE_STRING);
+        ljson_item_t *value = ljson_map_search(entry, "value");
+        if(!op || !path ||
+           (!strcmp(op->str, "remove") == (value != NULL))) {
+            return 0;
+        }
+        size_t used = strlen(buf);
+        snprintf(&buf[used], len - used, "%s%s %s", i ? "," : "", op->str, path->str);
+    }
+    return 1;
+}
+
+int main() {
+    int pass = 0, fail = 0;
+
+    printf("Test 10: Test structural diffs and merge patches\n"
+           "----------\n");
+
+    for(unsigned i = 0; i < N_DIFFS; i++) {
+        ljson_t *a     = ljson_parse(_diffs[i].a, 0);
+        ljson_t *b     = ljson_parse(_diffs[i].b, 0);
+        ljson_t *patch = (a && b) ? ljson_diff(&a->root, &b->root) : NULL;
+
+        /* The same patch should result from precomputed hashes */
+        ljson_hashes_t *ha     = a ? ljson_hash(&a->root) : NULL;
+        ljson_hashes_t *hb     = b ? ljson_hash(&b->root) : NULL;
+        ljson_t        *hashed = (ha && hb) ? ljson_diff_hashed(ha, hb) : NULL;
+
+        char ops[256], hashed_ops[256];
+        if(!patch || !hashed ||
+           !_ops(patch, ops, sizeof(ops)) ||
+           !_ops(hashed, hashed_ops, sizeof(hashed_ops)) ||
+           strcmp(ops, _diffs[i].ops) ||
+           strcmp(hashed_ops, _diffs[i].ops)) {
+            fprintf(stderr, "\033[31mFAIL\033[0m on diff %02u: %s -> %s\n", i, _diffs[i].a, _diffs[i].b);
+            fail++;
+        } else {
+            pass++;
+            fprintf(stderr, "\033[32mPASS\033[0m on diff %02u: %s -> %s\n", i, _diffs[i].a, _diffs[i].b);
+        }
+
+        ljson_hashes_destroy(ha);
+        ljson_hashes_destroy(hb);
+        if(hashed) ljson_destroy(hashed);
+        if(patch)  ljson_destroy(patch);
+        if(a)      ljson_destroy(a);
+        if(b)      ljson_destroy(b);
+    }
+
+    for(unsigned i = 0; i < N_MERGES; i++) {
+        ljson_t *base     = ljson_parse(_merges[i].base, 0);
+        ljson_t *patch    = ljson_parse(_merges[i].patch, 0);
+        ljson_t *expected = ljson_parse(_merges[i].result, 0);
+        ljson_t *diff     = NULL;
+
+        if(base && patch && expected &&
+           !ljson_merge(base, &patch->root)) {
+            diff = ljson_diff(&base->root, &expected->root);
+        }
+
+        if(!diff || diff->root.array->count) {
+            fprintf(stderr, "\033[31mFAIL\033[0m on merge %02u: %s + %s\n", i, _merges[i].base, _merges[i].patch);
+            fail++;
+        } else {
+            pass++;
+            fprintf(stderr, "\033[32mPASS\033[0m on merge %02u: %s + %s\n", i, _merges[i].base, _merges[i].patch);
+        }
+
+        if(diff)     ljson_destroy(diff);
+        if(base)     ljson_destroy(base);
+        if(patch)    ljson_destroy(patch);
+        if(expected) ljson_destroy(expected);
+    }
+
+    printf("----------\n"
+           "Pass: %d\n"
+           "Fail: %d\n", pass, fail);
+
+    return (fail > 0) ? -1 : 0;
+}
@@ -0,0 +1,167 @@
+#include <pthread.h>
+#include <stdio.h>
+
+#include "lambda-json.h"
+
+/* Test 11:
+ *   Tests concurrent reads of a shared document, and publishing new versions
+ *   of a document while it is being read. Build with SANITIZE=thread to check
+ *   for data races. */
+
+#define N_THREADS  4
+#define N_KEYS     64
+#define N_LOOKUPS  20000
+#define N_VERSIONS 500
+
+/**
+ * Build { "k0": 0, "k1": 1, ... }, with version added to each value */
+static ljson_t *_build(LJSON_INTTYPE version) {
+    ljson_t *json = ljson_create(NULL);
+    if(!json) {
+        return NULL;
+    }
+
+    ljson_item_t map = { .type = LJSON_ITEMTYPE_MAP };
+    if(ljson_item_set(json, &json->root, &map)) {
+        ljson_destroy(json);
+        return NULL;
+    }
+
+    for(int i = 0; i < N_KEYS; i++) {
+        char key[8];
+        snprintf(key, sizeof(key), "k%d", i);
+        ljson_item_t value = { .type = LJSON_ITEMTYPE_INTEGER, .integer = version + i };
+        if(!ljson_map_set(json, &json->root, key, &value)) {
+            ljson_destroy(json);
+            return NULL;
+        }
+    }
+
+    return json;
+}
+
+/**
+ * Check every value of a document produced by _build, returning its version
+ * or -1 if it is inconsistent */
+static LJSON_INTTYPE _check(ljson_t *json) {
+    LJSON_INTTYPE version = -1;
+    for(int i = 0; i < N_KEYS; i++) {
+        char key[8];
+        snprintf(key, sizeof(key), "k%d", i);
+        ljson_item_t *item = ljson_map_search_type(json->root.map, key, LJSON_ITEMTYPE_INTEGER);
+        LJSON_INTTYPE value;
+        if(!item || ljson_number_int(item, &value)) {
+            return -1;
+        }
+        if(i == 0) {
+            version = value;
+        } else if(value != version + i) {
+            return -1;
+        }
+    }
+    return version;
+}
+
+static ljson_t      *_frozen;
+static ljson_slot_t *_slot;
+
+static void *_read_frozen(void *arg) {
+    int *ok = (int *)arg;
+    for(int i = 0; i < N_LOOKUPS / N_KEYS; i++) {
+        if(_check(_frozen) != 0) {
+            *ok = 0;
+            return NULL;
+        }
+    }
+    *ok = 1;
+    return NULL;
+}
+
+static void *_read_slot(void *arg) {
+    int          *ok   = (int *)arg;
+    LJSON_INTTYPE last = 0;
+
+    *ok = 1;
+    while(last < N_VERSIONS) {
+        ljson_shared_t *shared = ljson_slot_acquire(_slot);
+        if(!shared) {
+            *ok = 0;
+            return NULL;
+        }
+
+        /* Versions are published in order, so must never go backwards */
+        LJSON_INTTYPE version = _check(ljson_shared_doc(shared));
+        ljson_shared_unref(shared);
+        if(version < last) {
+            *ok = 0;
+            return NULL;
+        }
+        last = version;
+    }
+    return NULL;
+}
+
+static int _run(void *(*fn)(void *), int publish) {
+    pthread_t threads[N_THREADS];
+    int       ok[N_THREADS];
+    int       started = 0;
+
+    for(; started < N_THREADS; started++) {
+        if(pthread_create(&threads[started], NULL, fn, &ok[started])) {
+            break;
+        }
+    }
+
+    int result = (started == N_THREADS);
+    for(LJSON_INTTYPE version = 1; publish && (version <= N_VERSIONS); version++) {
+        /* Publishing nothing stops the readers, on error */
+        ljson_shared_t *shared = ljson_shared_create(_build(version));
+        ljson_slot_publish(_slot, shared);
+        ljson_shared_unref(shared);
+        if(!shared) {
+            result = 0;
+            break;
+        }
+    }
+
+    for(int i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+        result = result && ok[i];
+    }
+    return result;
+}
+
+static void _report(const char *name, int ok, int *pass, int *fail) {
+    if(ok) {
+        (*pass)++;
+        fprintf(stderr, "\033[32mPASS\033[0m on %s\n", name);
+    } else {
+        (*fail)++;
+        fprintf(stderr, "\033[31mFAIL\033[0m on %s\n", name);
+    }
+}
+
+int main() {
+    int pass = 0, fail = 0;
+
+    printf("Test 11: Test concurrent reads and publishing of shared documents\n"
+           "----------\n");
+
+    _frozen = _build(0);
+    _report("concurrent reads", _frozen && _run(_read_frozen, 0), &pass, &fail);
+
+    /* Keep a reference to the first version, it must outlive the slot */
+    ljson_shared_t *first = ljson_shared_create(_frozen);
+    _slot = ljson_slot_create(first);
+    _report("concurrent reads while publishing", _slot && _run(_read_slot, 1), &pass, &fail);
+
+    ljson_slot_destroy(_slot);
+    _report("reference outliving slot", first && (_check(ljson_shared_doc(first)) == 0), &pass, &fail);
+    ljson_shared_unref(first);
+
+    printf("----------\n"
+           "Pass: %d\n"
+           "Fail: %d\n", pass, fail);
+
+    return (fail > 0) ? -1 : 0;
+}
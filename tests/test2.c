@@ -130,8 +130,12 @@ static int _check(const ljson_item_t *result, const ljson_item_t *expected) {
     
     switch(result->type) {
         case LJSON_ITEMTYPE_STRING:
+        case LJSON_ITEMTYPE_RAWNUMBER:
             return !strcmp(result->str, expected->str);
         
+        case LJSON_ITEMTYPE_BOOLEAN:
+            return result->boolean == expected->boolean;
+
         case LJSON_ITEMTYPE_INTEGER:
             return result->integer == expected->integer;
         
@@ -0,0 +1,81 @@
+#include <string.h>
+#include <stdio.h>
+
+#include "lambda-json.h"
+
+/* Test 4:
+ *   Tests parsing repeatedly into a reusable context. Uses a deliberately
+ *   small context so later inputs force it to grow. Use Valgrind to ensure
+ *   data is properly free'd by ljson_ctx_destroy. */
+
+static const struct {
+    const char *json;
+    int         result;
+} _tests[] = {
+    { "{'a':1,'b':'str'}",                                      1 },
+    { "[0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17,18,19,20]", 1 },
+    { "{'a':[1,2,",                                             0 },
+    { "{'a':{'b':{'c':{'d':[null,'deep string value',1.5]}}}}", 1 },
+    { "{'a':1,'b':'str'}",                                      1 },
+    { "null",                                                   1 },
+    { "[32,]",                                                  0 },
+    { "{'a':1,'b':'str'}",                                      1 },
+};
+#define N_TESTS (sizeof(_tests) / sizeof(_tests[0]))
+
+static int _check(ljson_t *json) {
+    /* Documents in a context must still be usable as normal */
+    if(json->root.type != LJSON_ITEMTYPE_MAP) {
+        return 1;
+    }
+    ljson_item_t *a = ljson_map_search_type(json->root.map, "a", LJSON_ITEMTYPE_INTEGER);
+    ljson_item_t *b = ljson_map_search_type(json->root.map, "b", LJSON_ITEMTYPE_STRING);
+    if(a && b) {
+        return (a->integer == 1) && !strcmp(b->str, "str");
+    }
+    a = ljson_map_search_type(json->root.map, "a", LJSON_ITEMTYPE_MAP);
+    return (a != NULL);
+}
+
+int main() {
+    int pass = 0, fail = 0;
+    ljson_t *json;
+
+    printf("Test 4: Test parsing into a reusable context\n"
+           "----------\n");
+
+    ljson_ctx_t *ctx = ljson_ctx_create(64);
+    if(!ctx) {
+        fprintf(stderr, "\033[31mFAIL\033[0m could not create context\n");
+        return -1;
+    }
+
+    /* Run the set twice, so the second pass runs on a context already grown
+     * to fit the largest input */
+    for(unsigned pass_n = 0; pass_n < 2; pass_n++) {
+        for(unsigned i = 0; i < N_TESTS; i++) {
+            json = ljson_parse_into(ctx, _tests[i].json, 0);
+            if((_tests[i].result  && (!json || !_check(json))) ||
+               (!_tests[i].result &&  json)) {
+                fprintf(stderr, "\033[31mFAIL\033[0m on test %02u: %s\n", i, _tests[i].json);
+                fail++;
+            } else {
+                pass++;
+                fprintf(stderr, "\033[32mPASS\033[0m on test %02u: %s\n", i, _tests[i].json);
+            }
+
+            if(json) {
+                /* Must not free context-owned storage */
+                ljson_destroy(json);
+            }
+        }
+    }
+
+    ljson_ctx_destroy(ctx);
+
+    printf("----------\n"
+           "Pass: %d\n"
+           "Fail: %d\n", pass, fail);
+
+    return (fail > 0) ? -1 : 0;
+}
@@ -0,0 +1,142 @@
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include "lambda-json.h"
+
+/* Test 5:
+ *   Tests parsing of memory-mapped files, and of inputs which are not
+ *   NUL-terminated. */
+
+/* Page-sized input, so the mapping has no trailing NUL past the file */
+#define LONG_LEN 4096
+
+static const struct {
+    const char *json;
+    const char *str; /** Expected value of "s", NULL if parsing should fail */
+} _tests[] = {
+    { "{'s':'str','i':12}",              "str" },
+    { "{\"s\":\"\\\"str\\\"\",'i':-3}",  "\"str\"" },
+    { "{'s':'\\\\str','i':1.5}",         "\\str" },
+    { "{'i':[1,2,{'x':null}],'s':'a'}", "a" },
+    { "{'s':'str','i':12",               NULL },
+    { "{'s':'str'} x",                   NULL },
+    { "",                                NULL },
+};
+#define N_TESTS (sizeof(_tests) / sizeof(_tests[0]))
+
+static const uint32_t _flags[] = {
+    0,
+    LJSON_PARSEFLAG_ZEROCOPY,
+    LJSON_PARSEFLAG_ZEROCOPY | LJSON_PARSEFLAG_WILLNEED
+};
+#define N_FLAGS (sizeof(_flags) / sizeof(_flags[0]))
+
+static int _write_file(char *path, const char *data, size_t len) {
+    int fd = mkstemp(path);
+    if(fd < 0) {
+        return -1;
+    }
+    if(write(fd, data, len) != (ssize_t)len) {
+        close(fd);
+        return -1;
+    }
+    close(fd);
+    return 0;
+}
+
+static int _check(ljson_t *json, const char *str) {
+    if(!str) {
+        return (json == NULL);
+    }
+    if(!json || (json->root.type != LJSON_ITEMTYPE_MAP)) {
+        return 0;
+    }
+    ljson_item_t *s = ljson_map_search_type(json->root.map, "s", LJSON_ITEMTYPE_STRING);
+    return s && !strcmp(s->str, str) && ljson_map_search(json->root.map, "i");
+}
+
+int main() {
+    int pass = 0, fail = 0;
+    ljson_t *json;
+
+    printf("Test 5: Test parsing of memory-mapped files and unterminated input\n"
+           "----------\n");
+
+    for(unsigned i = 0; i < N_TESTS; i++) {
+        for(unsigned f = 0; f < N_FLAGS; f++) {
+            char path[] = "/tmp/ljson-test5-XXXXXX";
+            if(_write_file(path, _tests[i].json, strlen(_tests[i].json))) {
+                fprintf(stderr, "\033[31mFAIL\033[0m could not write %s\n", path);
+                return -1;
+            }
+
+            json = ljson_parse_file(path, _flags[f]);
+            unlink(path);
+            if(!_check(json, _tests[i].str)) {
+                fprintf(stderr, "\033[31mFAIL\033[0m on test %02u, flags %x: %s\n", i, _flags[f], _tests[i].json);
+                fail++;
+            } else {
+                pass++;
+                fprintf(stderr, "\033[32mPASS\033[0m on test %02u, flags %x: %s\n", i, _flags[f], _tests[i].json);
+            }
+            if(json) {
+                ljson_destroy(json);
+            }
+        }
+
+        /* Same input, bounded by length, followed by data that would be
+         * misparsed if it were read */
+        size_t len = strlen(_tests[i].json);
+        char  *buf = (char *)malloc(len + 2);
+        memcpy(buf, _tests[i].json, len);
+        memcpy(&buf[len], "]}", 2);
+        json = ljson_parse_len(buf, len, 0);
+        if(!_check(json, _tests[i].str)) {
+            fprintf(stderr, "\033[31mFAIL\033[0m on test %02u, by length: %s\n", i, _tests[i].json);
+            fail++;
+        } else {
+            pass++;
+            fprintf(stderr, "\033[32mPASS\033[0m on test %02u, by length: %s\n", i, _tests[i].json);
+        }
+        if(json) {
+            ljson_destroy(json);
+        }
+        free(buf);
+    }
+
+    /* Page-sized file ending in a number, which must not be read past */
+    char *longjson = (char *)malloc(LONG_LEN);
+    memset(longjson, ' ', LONG_LEN);
+    memcpy(&longjson[LONG_LEN - 4], "1234", 4);
+    for(unsigned f = 0; f < N_FLAGS; f++) {
+        char path[] = "/tmp/ljson-test5-XXXXXX";
+        if(_write_file(path, longjson, LONG_LEN)) {
+            fprintf(stderr, "\033[31mFAIL\033[0m could not write %s\n", path);
+            return -1;
+        }
+
+        json = ljson_parse_file(path, _flags[f]);
+        unlink(path);
+        if(!json ||
+           (json->root.type    != LJSON_ITEMTYPE_INTEGER) ||
+           (json->root.integer != 1234)) {
+            fprintf(stderr, "\033[31mFAIL\033[0m on page-sized file, flags %x\n", _flags[f]);
+            fail++;
+        } else {
+            pass++;
+            fprintf(stderr, "\033[32mPASS\033[0m on page-sized file, flags %x\n", _flags[f]);
+        }
+        if(json) {
+            ljson_destroy(json);
+        }
+    }
+    free(longjson);
+
+    printf("----------\n"
+           "Pass: %d\n"
+           "Fail: %d\n", pass, fail);
+
+    return (fail > 0) ? -1 : 0;
+}
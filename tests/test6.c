@@ -0,0 +1,165 @@
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include "lambda-json.h"
+
+/* Test 6:
+ *   Tests saving documents as binary images, and loading them back. */
+
+static const char *_tests[] = {
+    "0",
+    "-3.14",
+    "'str'",
+    "null",
+    "[]",
+    "{}",
+    "[0,'a',[1,[2,[]]],{'b':null}]",
+    "{'a':{'b':{'c':'deep'}},'d':[1,2.5,'e'],'f':''}",
+    "{'0':{'a':{'A':{'_':null}},'b':{},'c':24}}"
+};
+#define N_TESTS (sizeof(_tests) / sizeof(_tests[0]))
+
+#define ABS(X) (((X) >= 0) ? (X) : -(X))
+
+static int _check(const ljson_item_t *result, const ljson_item_t *expected) {
+    if(result->type != expected->type) {
+        return 0;
+    }
+
+    switch(result->type) {
+        case LJSON_ITEMTYPE_STRING:
+        case LJSON_ITEMTYPE_RAWNUMBER:
+            return !strcmp(result->str, expected->str);
+
+        case LJSON_ITEMTYPE_BOOLEAN:
+            return result->boolean == expected->boolean;
+
+        case LJSON_ITEMTYPE_INTEGER:
+            return result->integer == expected->integer;
+
+        case LJSON_ITEMTYPE_FLOAT:
+            return ABS(result->flt - expected->flt) < 0.0001;
+
+        case LJSON_ITEMTYPE_ARRAY:
+            if(result->array->count != expected->array->count) {
+                return 0;
+            }
+            for(uint16_t i = 0; i < result->array->count; i++) {
+                if(!_check(&result->array->items[i], &expected->array->items[i])) {
+                    return 0;
+                }
+            }
+            return 1;
+
+        case LJSON_ITEMTYPE_MAP:
+            if(result->map->count != expected->map->count) {
+                return 0;
+            }
+            for(uint16_t i = 0; i < result->map->count; i++) {
+                /* Lookups must work directly on the loaded image */
+                ljson_item_t *item = ljson_map_search(result->map, expected->map->items[i].name);
+                if(!item ||
+                   !_check(item, &expected->map->items[i].item)) {
+                    return 0;
+                }
+            }
+            return 1;
+
+        case LJSON_ITEMTYPE_NULL:
+        case LJSON_ITEMTYPE_NONE:
+            return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * Overwrite a byte of the file, to check that damaged images are rejected */
+static int _corrupt(const char *path, long off) {
+    FILE *fp = fopen(path, "r+b");
+    if(!fp) {
+        return -1;
+    }
+    fseek(fp, off, SEEK_SET);
+    int ch = fgetc(fp);
+    fseek(fp, off, SEEK_SET);
+    fputc(ch ^ 0x5a, fp);
+    fclose(fp);
+    return 0;
+}
+
+int main() {
+    int pass = 0, fail = 0;
+    ljson_t *json, *loaded;
+
+    printf("Test 6: Test saving and loading of binary images\n"
+           "----------\n");
+
+    for(unsigned i = 0; i < N_TESTS; i++) {
+        char path[] = "/tmp/ljson-test6-XXXXXX";
+        int fd = mkstemp(path);
+        if(fd < 0) {
+            fprintf(stderr, "\033[31mFAIL\033[0m could not create %s\n", path);
+            return -1;
+        }
+        close(fd);
+
+        json   = ljson_parse(_tests[i], 0);
+        loaded = NULL;
+        if(json && !ljson_save_binary(json, path)) {
+            loaded = ljson_load_binary(path, 0);
+        }
+
+        if(!json || !loaded || !_check(&loaded->root, &json->root)) {
+            fprintf(stderr, "\033[31mFAIL\033[0m on test %02u: %s\n", i, _tests[i]);
+            fail++;
+        } else {
+            pass++;
+            fprintf(stderr, "\033[32mPASS\033[0m on test %02u: %s\n", i, _tests[i]);
+        }
+        if(loaded) {
+            ljson_destroy(loaded);
+        }
+
+        /* Damage the image just past the header */
+        loaded = NULL;
+        if(!_corrupt(path, 48)) {
+            loaded = ljson_load_binary(path, 0);
+        }
+        if(loaded) {
+            fprintf(stderr, "\033[31mFAIL\033[0m on test %02u, corrupted: %s\n", i, _tests[i]);
+            ljson_destroy(loaded);
+            fail++;
+        } else {
+            pass++;
+            fprintf(stderr, "\033[32mPASS\033[0m on test %02u, corrupted: %s\n", i, _tests[i]);
+        }
+
+        /* Truncated images must be rejected even without the checksum */
+        loaded = NULL;
+        if(!truncate(path, 40)) {
+            loaded = ljson_load_binary(path, LJSON_PARSEFLAG_NOCHECKSUM);
+        }
+        if(loaded) {
+            fprintf(stderr, "\033[31mFAIL\033[0m on test %02u, truncated: %s\n", i, _tests[i]);
+            ljson_destroy(loaded);
+            fail++;
+        } else {
+            pass++;
+            fprintf(stderr, "\033[32mPASS\033[0m on test %02u, truncated: %s\n", i, _tests[i]);
+        }
+
+        unlink(path);
+        if(json) {
+            ljson_destroy(json);
+        }
+    }
+
+    printf("----------\n"
+           "Pass: %d\n"
+           "Fail: %d\n", pass, fail);
+
+    return (fail > 0) ? -1 : 0;
+}
@@ -0,0 +1,94 @@
+#include <string.h>
+#include <stdio.h>
+
+#include "lambda-json.h"
+
+/* Test 7:
+ *   Tests integer range handling, and parsing of numbers as raw text. */
+
+static const struct {
+    const char   *json;
+    uint32_t      flags;
+    int           result; /** Whether parsing should succeed */
+    const char   *raw;    /** Expected text, if parsed as raw number */
+    LJSON_INTTYPE integer;
+    int           isint;  /** Whether ljson_number_int should succeed */
+} _tests[] = {
+    { "1234",                 0, 1, NULL, 1234, 1 },
+    { "-1234",                0, 1, NULL, -1234, 1 },
+    { "9007199254740993",     0, 1, NULL, 9007199254740993LL, 1 },
+    { "9223372036854775807",  0, 1, NULL, 9223372036854775807LL, 1 },
+    { "-9223372036854775808", 0, 1, NULL, (-9223372036854775807LL - 1), 1 },
+    { "9223372036854775808",  0, 0, NULL, 0, 0 },
+    { "99999999999999999999", 0, 0, NULL, 0, 0 },
+    { "1.5",                  0, 1, NULL, 0, 0 },
+    { "1e5",                  0, 1, NULL, 0, 0 },
+    { "-2E-3",                0, 1, NULL, 0, 0 },
+
+    { "1234",                 LJSON_PARSEFLAG_RAWNUMBERS, 1, "1234", 1234, 1 },
+    { "-9223372036854775808", LJSON_PARSEFLAG_RAWNUMBERS, 1, "-9223372036854775808", (-9223372036854775807LL - 1), 1 },
+    { "99999999999999999999", LJSON_PARSEFLAG_RAWNUMBERS, 1, "99999999999999999999", 0, 0 },
+    { "1.5e3",                LJSON_PARSEFLAG_RAWNUMBERS, 1, "1.5e3", 0, 0 },
+    { "-",                    LJSON_PARSEFLAG_RAWNUMBERS, 0, NULL, 0, 0 },
+    { "1.2.3",                LJSON_PARSEFLAG_RAWNUMBERS, 0, NULL, 0, 0 },
+};
+#define N_TESTS (sizeof(_tests) / sizeof(_tests[0]))
+
+static int _check(ljson_t *json, unsigned i) {
+    if(!_tests[i].result) {
+        return (json == NULL);
+    }
+    if(!json) {
+        return 0;
+    }
+
+    if(_tests[i].raw) {
+        if((json->root.type != LJSON_ITEMTYPE_RAWNUMBER) ||
+           strcmp(json->root.str, _tests[i].raw)) {
+            return 0;
+        }
+    }
+
+    LJSON_INTTYPE   integer;
+    LJSON_FLOATTYPE flt;
+    if(_tests[i].isint) {
+        if(ljson_number_int(&json->root, &integer) ||
+           (integer != _tests[i].integer)) {
+            return 0;
+        }
+    } else if(!ljson_number_int(&json->root, &integer)) {
+        return 0;
+    }
+
+    /* Any number can be had as floating-point */
+    return !ljson_number_float(&json->root, &flt);
+}
+
+int main() {
+    int pass = 0, fail = 0;
+    ljson_t *json;
+
+    printf("Test 7: Test integer range and raw number handling\n"
+           "----------\n");
+
+    for(unsigned i = 0; i < N_TESTS; i++) {
+        json = ljson_parse(_tests[i].json, _tests[i].flags);
+        if(!_check(json, i)) {
+            fprintf(stderr, "\033[31mFAIL\033[0m on test %02u: %s\n", i, _tests[i].json);
+            fail++;
+        } else {
+            pass++;
+            fprintf(stderr, "\033[32mPASS\033[0m on test %02u: %s\n", i, _tests[i].json);
+        }
+
+        if(json) {
+            ljson_destroy(json);
+        }
+    }
+
+    printf("----------\n"
+           "Pass: %d\n"
+           "Fail: %d\n", pass, fail);
+
+    return (fail > 0) ? -1 : 0;
+}
@@ -0,0 +1,105 @@
+#include <stdio.h>
+
+#include "lambda-json.h"
+
+/* Test 8:
+ *   Tests literals, and the functionality of LJSON_PARSEFLAG_STRICT. */
+
+static const struct {
+    const char      *json;
+    uint32_t         flags;
+    int              result;
+    ljson_itemtype_e type;    /** Expected type of first array item */
+    int              boolean; /** Expected value, if boolean */
+} _tests[] = {
+    { "[true]",         0, 1, LJSON_ITEMTYPE_BOOLEAN, 1 },
+    { "[false]",        0, 1, LJSON_ITEMTYPE_BOOLEAN, 0 },
+    { "[null]",         0, 1, LJSON_ITEMTYPE_NULL,    0 },
+    { "[True]",         0, 1, LJSON_ITEMTYPE_BOOLEAN, 1 },
+    { "[FALSE]",        0, 1, LJSON_ITEMTYPE_BOOLEAN, 0 },
+    { "[NULL]",         0, 1, LJSON_ITEMTYPE_NULL,    0 },
+    { "[+1]",           0, 1, LJSON_ITEMTYPE_INTEGER, 0 },
+    { "['str']",        0, 1, LJSON_ITEMTYPE_STRING,  0 },
+    { "[{'a':1}]",      0, 1, LJSON_ITEMTYPE_MAP,     0 },
+    { "[tru]",          0, 0, LJSON_ITEMTYPE_NONE,    0 },
+    { "[fals]",         0, 0, LJSON_ITEMTYPE_NONE,    0 },
+    { "[falsy]",        0, 0, LJSON_ITEMTYPE_NONE,    0 },
+    { "[nul]",          0, 0, LJSON_ITEMTYPE_NONE,    0 },
+    { "[nUlL,true]",    0, 1, LJSON_ITEMTYPE_NULL,    0 },
+
+    { "[true]",         LJSON_PARSEFLAG_STRICT, 1, LJSON_ITEMTYPE_BOOLEAN, 1 },
+    { "[false]",        LJSON_PARSEFLAG_STRICT, 1, LJSON_ITEMTYPE_BOOLEAN, 0 },
+    { "[null]",         LJSON_PARSEFLAG_STRICT, 1, LJSON_ITEMTYPE_NULL,    0 },
+    { "[-1]",           LJSON_PARSEFLAG_STRICT, 1, LJSON_ITEMTYPE_INTEGER, 0 },
+    { "[\"str\"]",      LJSON_PARSEFLAG_STRICT, 1, LJSON_ITEMTYPE_STRING,  0 },
+    { "[{\"a\":1}]",    LJSON_PARSEFLAG_STRICT, 1, LJSON_ITEMTYPE_MAP,     0 },
+    { "[True]",         LJSON_PARSEFLAG_STRICT, 0, LJSON_ITEMTYPE_NONE,    0 },
+    { "[falsE]",        LJSON_PARSEFLAG_STRICT, 0, LJSON_ITEMTYPE_NONE,    0 },
+    { "[NULL]",         LJSON_PARSEFLAG_STRICT, 0, LJSON_ITEMTYPE_NONE,    0 },
+    { "[+1]",           LJSON_PARSEFLAG_STRICT, 0, LJSON_ITEMTYPE_NONE,    0 },
+    { "['str']",        LJSON_PARSEFLAG_STRICT, 0, LJSON_ITEMTYPE_NONE,    0 },
+    { "[{'a':1}]",      LJSON_PARSEFLAG_STRICT, 0, LJSON_ITEMTYPE_NONE,    0 },
+    { "[0]",            LJSON_PARSEFLAG_STRICT, 1, LJSON_ITEMTYPE_INTEGER, 0 },
+    { "[-0.5e+3]",      LJSON_PARSEFLAG_STRICT, 1, LJSON_ITEMTYPE_FLOAT,   0 },
+    { "[1E5]",          LJSON_PARSEFLAG_STRICT, 1, LJSON_ITEMTYPE_FLOAT,   0 },
+    { "[01]",           LJSON_PARSEFLAG_STRICT, 0, LJSON_ITEMTYPE_NONE,    0 },
+    { "[-01]",          LJSON_PARSEFLAG_STRICT, 0, LJSON_ITEMTYPE_NONE,    0 },
+    { "[-.5]",          LJSON_PARSEFLAG_STRICT, 0, LJSON_ITEMTYPE_NONE,    0 },
+    { "[1.]",           LJSON_PARSEFLAG_STRICT, 0, LJSON_ITEMTYPE_NONE,    0 },
+    { "[1.e5]",         LJSON_PARSEFLAG_STRICT, 0, LJSON_ITEMTYPE_NONE,    0 },
+    { "[1e]",           LJSON_PARSEFLAG_STRICT, 0, LJSON_ITEMTYPE_NONE,    0 },
+    { "[01]",           LJSON_PARSEFLAG_STRICT | LJSON_PARSEFLAG_RAWNUMBERS, 0, LJSON_ITEMTYPE_NONE, 0 },
+    { "01",             LJSON_PARSEFLAG_STRICT | LJSON_PARSEFLAG_RAWNUMBERS, 0, LJSON_ITEMTYPE_NONE, 0 },
+    { "-",              LJSON_PARSEFLAG_STRICT | LJSON_PARSEFLAG_LENIENT,    0, LJSON_ITEMTYPE_NONE, 0 },
+    { "-abc",           LJSON_PARSEFLAG_STRICT | LJSON_PARSEFLAG_LENIENT,    0, LJSON_ITEMTYPE_NONE, 0 },
+    { "[01]",           0,                      1, LJSON_ITEMTYPE_INTEGER, 0 },
+    { "[1.]",           0,                      1, LJSON_ITEMTYPE_FLOAT,   0 },
+};
+#define N_TESTS (sizeof(_tests) / sizeof(_tests[0]))
+
+static int _check(ljson_t *json, unsigned i) {
+    if(!_tests[i].result) {
+        return (json == NULL);
+    }
+    if(!json ||
+       (json->root.type         != LJSON_ITEMTYPE_ARRAY) ||
+       (json->root.array->count <  1)) {
+        return 0;
+    }
+
+    ljson_item_t *item = &json->root.array->items[0];
+    if(item->type != _tests[i].type) {
+        return 0;
+    }
+    return (item->type != LJSON_ITEMTYPE_BOOLEAN) ||
+           (item->boolean == _tests[i].boolean);
+}
+
+int main() {
+    int pass = 0, fail = 0;
+    ljson_t *json;
+
+    printf("Test 8: Test literals and functionality of LJSON_PARSEFLAG_STRICT\n"
+           "----------\n");
+
+    for(unsigned i = 0; i < N_TESTS; i++) {
+        json = ljson_parse(_tests[i].json, _tests[i].flags);
+        if(!_check(json, i)) {
+            fprintf(stderr, "\033[31mFAIL\033[0m on test %02u: %s\n", i, _tests[i].json);
+            fail++;
+        } else {
+            pass++;
+            fprintf(stderr, "\033[32mPASS\033[0m on test %02u: %s\n", i, _tests[i].json);
+        }
+
+        if(json) {
+            ljson_destroy(json);
+        }
+    }
+
+    printf("----------\n"
+           "Pass: %d\n"
+           "Fail: %d\n", pass, fail);
+
+    return (fail > 0) ? -1 : 0;
+}
@@ -0,0 +1,166 @@
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include "lambda-json.h"
+
+/* Test 9:
+ *   Tests building and modifying documents, on the heap, within a context and
+ *   within a loaded binary image. Use Valgrind to ensure replaced and removed
+ *   values are properly free'd. */
+
+static const ljson_item_t _empty_map   = { .type = LJSON_ITEMTYPE_MAP };
+static const ljson_item_t _empty_array = { .type = LJSON_ITEMTYPE_ARRAY };
+static const ljson_item_t _str         = { .type = LJSON_ITEMTYPE_STRING, .str = "str" };
+static const ljson_item_t _yes         = { .type = LJSON_ITEMTYPE_BOOLEAN, .boolean = 1 };
+
+static int _int_is(const ljson_item_t *item, LJSON_INTTYPE value) {
+    return item && (item->type == LJSON_ITEMTYPE_INTEGER) && (item->integer == value);
+}
+
+/**
+ * Build { "a": [0, 1, ..., 99], "b": "str", "c": { "d": true } } */
+static int _build(ljson_t *json) {
+    if(ljson_item_set(json, &json->root, &_empty_map)) {
+        return 0;
+    }
+
+    ljson_item_t *a = ljson_map_set(json, &json->root, "a", &_empty_array);
+    if(!a) {
+        return 0;
+    }
+    for(LJSON_INTTYPE i = 0; i < 100; i++) {
+        ljson_item_t value = { .type = LJSON_ITEMTYPE_INTEGER, .integer = i };
+        if(!ljson_array_append(json, a, &value)) {
+            return 0;
+        }
+    }
+
+    ljson_item_t *c = NULL;
+    if(!ljson_map_set(json, &json->root, "b", &_str) ||
+       !(c = ljson_map_set(json, &json->root, "c", &_empty_map)) ||
+       !ljson_map_set(json, c, "d", &_yes)) {
+        return 0;
+    }
+
+    return 1;
+}
+
+/**
+ * Modify a document produced by _build, or parsed from the same content */
+static int _modify(ljson_t *json) {
+    ljson_map_t  *root = json->root.map;
+    ljson_item_t *a    = ljson_map_search_type(root, "a", LJSON_ITEMTYPE_ARRAY);
+    if(!a || (a->array->count != 100) || !_int_is(&a->array->items[99], 99)) {
+        return 0;
+    }
+
+    /* Insert at front, remove from the middle */
+    ljson_item_t value = { .type = LJSON_ITEMTYPE_INTEGER, .integer = -1 };
+    if(!ljson_array_insert(json, a, 0, &value) ||
+       ljson_array_remove(json, a, 50)         ||
+       !ljson_array_remove(json, a, 100)) {
+        return 0;
+    }
+    if((a->array->count != 100)                 ||
+       !_int_is(&a->array->items[0],  -1)       ||
+       !_int_is(&a->array->items[50], 50)       ||
+       !_int_is(&a->array->items[99], 99)) {
+        return 0;
+    }
+
+    /* Replace a value with part of itself */
+    ljson_item_t *c = ljson_map_search_type(root, "c", LJSON_ITEMTYPE_MAP);
+    if(!c || ljson_item_set(json, c, ljson_map_search(c->map, "d"))) {
+        return 0;
+    }
+
+    /* Replace, remove, and copy values within the document */
+    if(!ljson_map_set(json, &json->root, "b", a)   ||
+       ljson_map_remove(json, &json->root, "a")    ||
+       !ljson_map_remove(json, &json->root, "a")) {
+        return 0;
+    }
+
+    root = json->root.map;
+    ljson_item_t *b = ljson_map_search_type(root, "b", LJSON_ITEMTYPE_ARRAY);
+    c = ljson_map_search_type(root, "c", LJSON_ITEMTYPE_BOOLEAN);
+    return (root->count == 2) &&
+           !strcmp(root->items[0].name, "b") &&
+           b && (b->array->count == 100) && _int_is(&b->array->items[0], -1) &&
+           c && c->boolean;
+}
+
+static void _report(const char *name, int ok, int *pass, int *fail) {
+    if(ok) {
+        (*pass)++;
+        fprintf(stderr, "\033[32mPASS\033[0m on %s\n", name);
+    } else {
+        (*fail)++;
+        fprintf(stderr, "\033[31mFAIL\033[0m on %s\n", name);
+    }
+}
+
+int main() {
+    int pass = 0, fail = 0;
+    ljson_t *json;
+
+    printf("Test 9: Test building and modifying documents\n"
+           "----------\n");
+
+    /* Heap */
+    json = ljson_create(NULL);
+    _report("heap document", json && _build(json) && _modify(json), &pass, &fail);
+    if(json) {
+        ljson_destroy(json);
+    }
+
+    /* Context, kept small so documents have to move between blocks */
+    ljson_ctx_t *ctx = ljson_ctx_create(64);
+    json = ljson_create(ctx);
+    _report("context document", json && _build(json) && _modify(json), &pass, &fail);
+
+    /* Parsed, arrays and maps start out without room to grow */
+    char text[1024] = "{'a':[0";
+    for(int i = 1; i < 100; i++) {
+        sprintf(&text[strlen(text)], ",%d", i);
+    }
+    strcat(text, "],'b':'str','c':{'d':true}}");
+
+    json = ljson_parse(text, 0);
+    _report("parsed heap document", json && _modify(json), &pass, &fail);
+    if(json) {
+        ljson_destroy(json);
+    }
+
+    json = ljson_parse_into(ctx, text, 0);
+    _report("parsed context document", json && _modify(json), &pass, &fail);
+    ljson_ctx_destroy(ctx);
+
+    /* Binary image, stored in a file mapping */
+    char path[] = "/tmp/ljson-test9-XXXXXX";
+    int  fd     = mkstemp(path);
+    if(fd >= 0) {
+        close(fd);
+    }
+    json = ljson_parse(text, 0);
+    ljson_t *loaded = NULL;
+    if(json && (fd >= 0) && !ljson_save_binary(json, path)) {
+        loaded = ljson_load_binary(path, 0);
+    }
+    _report("binary image document", loaded && _modify(loaded), &pass, &fail);
+    if(loaded) {
+        ljson_destroy(loaded);
+    }
+    if(json) {
+        ljson_destroy(json);
+    }
+    unlink(path);
+
+    printf("----------\n"
+           "Pass: %d\n"
+           "Fail: %d\n", pass, fail);
+
+    return (fail > 0) ? -1 : 0;
+}